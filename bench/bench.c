@@ -0,0 +1,648 @@
+/* tds_bench : timed microbenchmarks for the engine's hot CPU paths.
+ *
+ * Every benchmark runs on synthetic data generated from a fixed seed, so runs are comparable across engine versions.
+ * A benchmark is calibrated until one sample takes at least TDS_BENCH_SAMPLE_MS, then timed over TDS_BENCH_SAMPLES samples.
+ * The median sample is reported along with the fastest one.
+ *
+ * The engine logs to stdout, so results are written as JSON to the file given on the command line (default tds_bench.json).
+ * Pass "-" to write them to stdout instead.
+ * Fixtures (config, string database, map) are written to a scratch directory which is removed afterwards. */
+
+#include "../src/tds.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#define TDS_BENCH_SAMPLES 7
+#define TDS_BENCH_SAMPLE_MS 25.0
+#define TDS_BENCH_MAX_RESULTS 32
+#define TDS_BENCH_SEED 0x7D5BE7C4u
+
+#define TDS_BENCH_HANDLE_COUNT 4096
+#define TDS_BENCH_QUADTREE_COUNT 4096
+#define TDS_BENCH_QUERY_COUNT 1024
+#define TDS_BENCH_STRINGDB_ENTRIES 256
+#define TDS_BENCH_PARAM_COUNT 16
+#define TDS_BENCH_MAP_SIZE 64
+#define TDS_BENCH_MAP_OBJECTS 256
+
+#define TDS_BENCH_BLOCK_SOLID 1
+#define TDS_BENCH_BLOCK_NOLIGHT 2
+#define TDS_BENCH_BLOCK_SLOPE 3
+#define TDS_BENCH_BLOCK_DECOR 4
+
+struct tds_bench_result {
+	const char* name;
+	long iterations, ops_per_iteration;
+	double ns_per_op, ns_per_op_min, ops_per_sec;
+};
+
+struct tds_bench_world_data {
+	struct tds_world* world;
+	int width, height;
+	uint8_t* blocks;
+};
+
+struct tds_bench_overlap_data {
+	struct tds_world* world;
+	struct tds_object* obj;
+	float* positions;
+	struct tds_world_overlap_query* queries;
+	int hits;
+};
+
+struct tds_bench_handle_data {
+	struct tds_handle_manager* hmgr;
+	handle* handles;
+	int dummy;
+};
+
+struct tds_bench_quadtree_data {
+	float* boxes;
+	struct tds_quadtree* tree;
+	int visited;
+};
+
+struct tds_bench_stringdb_data {
+	struct tds_stringdb* db;
+	char (*ids)[32];
+	int* id_lens;
+	int total_len;
+};
+
+struct tds_bench_param_data {
+	struct tds_object* obj;
+	long sum;
+};
+
+static struct tds_bench_result _tds_bench_results[TDS_BENCH_MAX_RESULTS];
+static int _tds_bench_result_count;
+static unsigned int _tds_bench_state = TDS_BENCH_SEED;
+
+static struct tds_object_type _tds_bench_type = {
+	.type_name = "obj_bench",
+	.msg_subscriptions = TDS_OBJECT_NO_BROADCASTS,
+	.msg_subscription_count = 0,
+	.save = 0,
+};
+
+static unsigned int _tds_bench_rand(void);
+static float _tds_bench_randf(float min, float max);
+static void _tds_bench_run(const char* name, long ops_per_iteration, void* data, void (*func)(void* data));
+static void _tds_bench_write(FILE* fd);
+static void _tds_bench_write_fixtures(void);
+static uint8_t* _tds_bench_make_grid(int width, int height);
+
+static void _tds_bench_handle_get(void* data);
+static void _tds_bench_handle_churn(void* data);
+static void _tds_bench_quadtree_insert(void* data);
+static void _tds_bench_quadtree_walk(void* data);
+static void _tds_bench_quadtree_walk_callback(void* usr, void* data);
+static void _tds_bench_world_hblocks(void* data);
+static void _tds_bench_world_segments(void* data);
+static void _tds_bench_world_set_block(void* data);
+static void _tds_bench_world_overlap(void* data);
+static void _tds_bench_world_overlap_batch(void* data);
+static void _tds_bench_world_sweep(void* data);
+static void _tds_bench_map_parse(void* data);
+static void _tds_bench_stringdb_get(void* data);
+static void _tds_bench_param_get(void* data);
+static void _tds_bench_param_set(void* data);
+
+int main(int argc, char** argv) {
+	char out_filename[PATH_MAX] = "tds_bench.json", scratch_dir[] = "/tmp/tds_bench.XXXXXX";
+
+	if (argc > 1) {
+		strncpy(out_filename, argv[1], sizeof out_filename - 1);
+	}
+
+	if (strcmp(out_filename, "-") && out_filename[0] != '/') {
+		/* Resolve the output path before moving into the scratch directory. */
+		char cwd[PATH_MAX] = {0};
+
+		if (getcwd(cwd, sizeof cwd)) {
+			char joined[PATH_MAX];
+			snprintf(joined, sizeof joined, "%s/%s", cwd, out_filename);
+			memcpy(out_filename, joined, sizeof out_filename);
+		}
+	}
+
+	if (!mkdtemp(scratch_dir) || chdir(scratch_dir)) {
+		fprintf(stderr, "tds_bench: failed to create a scratch directory\n");
+		return 1;
+	}
+
+	_tds_bench_write_fixtures();
+
+	struct tds_engine_desc desc = {0};
+
+	desc.config_filename = "bench.lua";
+	desc.map_filename = "none";
+	desc.stringdb_filename = "bench";
+	desc.headless = 1;
+
+	struct tds_engine* engine = tds_engine_create(desc);
+
+	engine->block_map_handle->buffer[TDS_BENCH_BLOCK_SOLID].flags = TDS_BLOCK_TYPE_SOLID;
+	engine->block_map_handle->buffer[TDS_BENCH_BLOCK_NOLIGHT].flags = TDS_BLOCK_TYPE_SOLID | TDS_BLOCK_TYPE_NOLIGHT;
+	engine->block_map_handle->buffer[TDS_BENCH_BLOCK_SLOPE].flags = TDS_BLOCK_TYPE_SOLID | TDS_BLOCK_TYPE_RTSLOPE;
+	engine->block_map_handle->buffer[TDS_BENCH_BLOCK_DECOR].flags = 0;
+
+	tds_object_type_cache_add(engine->otc_handle, _tds_bench_type.type_name, &_tds_bench_type);
+
+	/* Handle manager */
+	{
+		struct tds_bench_handle_data data = {0};
+
+		data.hmgr = tds_handle_manager_create(TDS_BENCH_HANDLE_COUNT);
+		data.handles = tds_malloc(sizeof *data.handles * TDS_BENCH_HANDLE_COUNT);
+
+		for (int i = 0; i < TDS_BENCH_HANDLE_COUNT; ++i) {
+			data.handles[i] = tds_handle_manager_get_new(data.hmgr, &data.dummy);
+		}
+
+		/* Visit the handles in a shuffled order so the lookups are not a linear sweep. */
+		for (int i = TDS_BENCH_HANDLE_COUNT - 1; i > 0; --i) {
+			int j = _tds_bench_rand() % (i + 1);
+			handle tmp = data.handles[i];
+			data.handles[i] = data.handles[j];
+			data.handles[j] = tmp;
+		}
+
+		_tds_bench_run("handle_get", TDS_BENCH_HANDLE_COUNT, &data, _tds_bench_handle_get);
+		_tds_bench_run("handle_set_new", TDS_BENCH_HANDLE_COUNT, &data, _tds_bench_handle_churn);
+
+		tds_free(data.handles);
+		tds_handle_manager_free(data.hmgr);
+	}
+
+	/* Quadtree */
+	{
+		struct tds_bench_quadtree_data data = {0};
+
+		data.boxes = tds_malloc(sizeof *data.boxes * 4 * TDS_BENCH_QUADTREE_COUNT);
+
+		for (int i = 0; i < TDS_BENCH_QUADTREE_COUNT; ++i) {
+			float x = _tds_bench_randf(-60.0f, 60.0f), y = _tds_bench_randf(-60.0f, 60.0f);
+			float w = _tds_bench_randf(0.5f, 4.0f), h = _tds_bench_randf(0.5f, 2.0f);
+
+			data.boxes[i * 4] = x - w / 2.0f;
+			data.boxes[i * 4 + 1] = x + w / 2.0f;
+			data.boxes[i * 4 + 2] = y + h / 2.0f;
+			data.boxes[i * 4 + 3] = y - h / 2.0f;
+		}
+
+		_tds_bench_run("quadtree_insert", TDS_BENCH_QUADTREE_COUNT, &data, _tds_bench_quadtree_insert);
+
+		data.tree = tds_quadtree_create(-64.0f, 64.0f, 64.0f, -64.0f);
+
+		for (int i = 0; i < TDS_BENCH_QUADTREE_COUNT; ++i) {
+			tds_quadtree_insert(data.tree, data.boxes[i * 4], data.boxes[i * 4 + 1], data.boxes[i * 4 + 2], data.boxes[i * 4 + 3], data.boxes + i * 4);
+		}
+
+		_tds_bench_run("quadtree_walk", TDS_BENCH_QUERY_COUNT, &data, _tds_bench_quadtree_walk);
+
+		tds_quadtree_free(data.tree);
+		tds_free(data.boxes);
+	}
+
+	/* World generation and queries */
+	{
+		struct tds_bench_world_data data = {0};
+
+		data.width = data.height = 256;
+		data.blocks = _tds_bench_make_grid(data.width, data.height);
+		data.world = tds_world_create();
+
+		tds_world_load(data.world, data.blocks, data.width, data.height);
+
+		_tds_bench_run("world_generate_hblocks_256x256", data.width * data.height, &data, _tds_bench_world_hblocks);
+		_tds_bench_run("world_set_block_256x256", 2, &data, _tds_bench_world_set_block);
+
+		tds_world_set_merge_rects(data.world, 1);
+		_tds_bench_run("world_generate_hblocks_merged_256x256", data.width * data.height, &data, _tds_bench_world_hblocks);
+		_tds_bench_run("world_set_block_merged_256x256", 2, &data, _tds_bench_world_set_block);
+		tds_world_set_merge_rects(data.world, 0);
+
+		struct tds_bench_overlap_data overlap = {0};
+
+		overlap.world = data.world;
+		overlap.obj = tds_object_create(&_tds_bench_type, engine->object_buffer, engine->kinematics_handle, engine->sc_handle, 0.0f, 0.0f, 0.0f, NULL, 0);
+		overlap.positions = tds_malloc(sizeof *overlap.positions * 2 * TDS_BENCH_QUERY_COUNT);
+
+		tds_object_set_cbox(overlap.obj, 0.4f, 0.9f);
+
+		for (int i = 0; i < TDS_BENCH_QUERY_COUNT * 2; ++i) {
+			overlap.positions[i] = _tds_bench_randf(-data.width * TDS_WORLD_BLOCK_SIZE / 2.0f, data.width * TDS_WORLD_BLOCK_SIZE / 2.0f);
+		}
+
+		_tds_bench_run("world_get_overlap_fast_256x256", TDS_BENCH_QUERY_COUNT, &overlap, _tds_bench_world_overlap);
+
+		overlap.queries = tds_malloc(sizeof *overlap.queries * TDS_BENCH_QUERY_COUNT);
+
+		for (int i = 0; i < TDS_BENCH_QUERY_COUNT; ++i) {
+			overlap.queries[i].x = overlap.positions[i * 2];
+			overlap.queries[i].y = overlap.positions[i * 2 + 1];
+			overlap.queries[i].w = 0.4f;
+			overlap.queries[i].h = 0.9f;
+		}
+
+		_tds_bench_run("world_get_overlap_batch_256x256", TDS_BENCH_QUERY_COUNT, &overlap, _tds_bench_world_overlap_batch);
+		_tds_bench_run("world_sweep_256x256", TDS_BENCH_QUERY_COUNT, &overlap, _tds_bench_world_sweep);
+
+		tds_object_free(overlap.obj);
+		tds_free(overlap.positions);
+		tds_free(overlap.queries);
+		tds_world_free(data.world);
+		tds_free(data.blocks);
+
+		/* Segment generation runs on a smaller grid, older engines reduce segments in quadratic time. */
+		data.width = data.height = 64;
+		data.blocks = _tds_bench_make_grid(data.width, data.height);
+		data.world = tds_world_create();
+
+		tds_world_load(data.world, data.blocks, data.width, data.height);
+
+		_tds_bench_run("world_generate_segments_64x64", data.width * data.height, &data, _tds_bench_world_segments);
+
+		tds_world_free(data.world);
+		tds_free(data.blocks);
+	}
+
+	/* Map parsing */
+	_tds_bench_run("map_parse_64x64", 1, engine, _tds_bench_map_parse);
+	tds_engine_flush_objects(engine);
+
+	/* String database */
+	{
+		struct tds_bench_stringdb_data data = {0};
+
+		data.db = engine->stringdb_handle;
+		data.ids = tds_malloc(sizeof *data.ids * TDS_BENCH_QUERY_COUNT);
+		data.id_lens = tds_malloc(sizeof *data.id_lens * TDS_BENCH_QUERY_COUNT);
+
+		for (int i = 0; i < TDS_BENCH_QUERY_COUNT; ++i) {
+			data.id_lens[i] = snprintf(data.ids[i], sizeof *data.ids, "bench_entry_%u", _tds_bench_rand() % TDS_BENCH_STRINGDB_ENTRIES);
+		}
+
+		_tds_bench_run("stringdb_get", TDS_BENCH_QUERY_COUNT, &data, _tds_bench_stringdb_get);
+
+		tds_free(data.ids);
+		tds_free(data.id_lens);
+	}
+
+	/* Object parameters */
+	{
+		struct tds_bench_param_data data = {0};
+		struct tds_object_param* params = tds_malloc(sizeof *params * TDS_BENCH_PARAM_COUNT);
+
+		for (int i = 0; i < TDS_BENCH_PARAM_COUNT; ++i) {
+			params[i].key = i * 2;
+			params[i].type = TDS_PARAM_INT;
+			params[i].ipart = i;
+		}
+
+		data.obj = tds_object_create(&_tds_bench_type, engine->object_buffer, engine->kinematics_handle, engine->sc_handle, 0.0f, 0.0f, 0.0f, params, TDS_BENCH_PARAM_COUNT);
+
+		/* Half of the lookups miss : keys are only stored at even indices. */
+		_tds_bench_run("object_param_get", TDS_BENCH_PARAM_COUNT * 2, &data, _tds_bench_param_get);
+		_tds_bench_run("object_param_set", TDS_BENCH_PARAM_COUNT, &data, _tds_bench_param_set);
+
+		tds_object_free(data.obj);
+	}
+
+	tds_engine_free(engine);
+
+	remove("bench.lua");
+	remove("res/strings/bench");
+	remove("res/maps/bench.tmx");
+	rmdir("res/strings");
+	rmdir("res/maps");
+	rmdir("res");
+
+	if (chdir("/") || rmdir(scratch_dir)) {
+		fprintf(stderr, "tds_bench: failed to remove scratch directory %s\n", scratch_dir);
+	}
+
+	if (!strcmp(out_filename, "-")) {
+		_tds_bench_write(stdout);
+		return 0;
+	}
+
+	FILE* fd = fopen(out_filename, "w");
+
+	if (!fd) {
+		fprintf(stderr, "tds_bench: failed to open %s for writing\n", out_filename);
+		return 1;
+	}
+
+	_tds_bench_write(fd);
+	fclose(fd);
+
+	fprintf(stderr, "tds_bench: wrote %d results to %s\n", _tds_bench_result_count, out_filename);
+
+	return 0;
+}
+
+static unsigned int _tds_bench_rand(void) {
+	/* Fixed LCG so the synthetic data does not depend on the C library's rand(). */
+	_tds_bench_state = _tds_bench_state * 1664525u + 1013904223u;
+	return _tds_bench_state >> 8;
+}
+
+static float _tds_bench_randf(float min, float max) {
+	return min + (max - min) * (_tds_bench_rand() & 0xFFFF) / 65535.0f;
+}
+
+static void _tds_bench_run(const char* name, long ops_per_iteration, void* data, void (*func)(void* data)) {
+	long iterations = 1;
+	double samples[TDS_BENCH_SAMPLES];
+
+	func(data); /* Warm up caches and any lazily created state. */
+
+	/* Calibrate : double the iteration count until one sample is long enough to time reliably. */
+	for (;;) {
+		tds_clock_point start = tds_clock_get_point();
+
+		for (long i = 0; i < iterations; ++i) {
+			func(data);
+		}
+
+		if (tds_clock_get_ms(start) >= TDS_BENCH_SAMPLE_MS) {
+			break;
+		}
+
+		iterations *= 2;
+	}
+
+	for (int i = 0; i < TDS_BENCH_SAMPLES; ++i) {
+		tds_clock_point start = tds_clock_get_point();
+
+		for (long j = 0; j < iterations; ++j) {
+			func(data);
+		}
+
+		samples[i] = tds_clock_get_ms(start) * 1000000.0 / (double) (iterations * ops_per_iteration);
+	}
+
+	/* Insertion sort, there are only a handful of samples. */
+	for (int i = 1; i < TDS_BENCH_SAMPLES; ++i) {
+		double key = samples[i];
+		int j = i - 1;
+
+		while (j >= 0 && samples[j] > key) {
+			samples[j + 1] = samples[j];
+			--j;
+		}
+
+		samples[j + 1] = key;
+	}
+
+	if (_tds_bench_result_count >= TDS_BENCH_MAX_RESULTS) {
+		fprintf(stderr, "tds_bench: too many results, dropping [%s]\n", name);
+		return;
+	}
+
+	struct tds_bench_result* result = _tds_bench_results + _tds_bench_result_count++;
+
+	result->name = name;
+	result->iterations = iterations;
+	result->ops_per_iteration = ops_per_iteration;
+	result->ns_per_op = samples[TDS_BENCH_SAMPLES / 2];
+	result->ns_per_op_min = samples[0];
+	result->ops_per_sec = 1000000000.0 / result->ns_per_op;
+
+	fprintf(stderr, "tds_bench: %-32s %12.1f ns/op %14.0f ops/s\n", name, result->ns_per_op, result->ops_per_sec);
+}
+
+static void _tds_bench_write(FILE* fd) {
+	fprintf(fd, "{\n\t\"version\": 1,\n\t\"samples\": %d,\n\t\"benchmarks\": [\n", TDS_BENCH_SAMPLES);
+
+	for (int i = 0; i < _tds_bench_result_count; ++i) {
+		struct tds_bench_result* result = _tds_bench_results + i;
+
+		fprintf(fd, "\t\t{\"name\": \"%s\", \"iterations\": %ld, \"ops_per_iteration\": %ld, \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"ops_per_sec\": %.1f}%s\n",
+			result->name, result->iterations, result->ops_per_iteration, result->ns_per_op, result->ns_per_op_min, result->ops_per_sec, (i + 1 < _tds_bench_result_count) ? "," : "");
+	}
+
+	fprintf(fd, "\t]\n}\n");
+}
+
+static uint8_t* _tds_bench_make_grid(int width, int height) {
+	/* Rolling terrain with a few floating platforms, slopes and non-solid decoration, roughly what a level looks like. */
+	uint8_t* output = tds_malloc(width * height);
+	memset(output, 0, width * height);
+
+	int ground = height / 3;
+
+	for (int x = 0; x < width; ++x) {
+		int step = _tds_bench_rand() % 5;
+
+		if (step == 0 && ground > 2) {
+			ground--;
+		} else if (step == 1 && ground < height / 2) {
+			ground++;
+		}
+
+		for (int y = 0; y < ground; ++y) {
+			output[y * width + x] = (y < ground - 4) ? TDS_BENCH_BLOCK_NOLIGHT : TDS_BENCH_BLOCK_SOLID;
+		}
+
+		if (step == 1) {
+			output[ground * width + x] = TDS_BENCH_BLOCK_SLOPE;
+		}
+
+		if (step == 4 && ground + 1 < height) {
+			output[(ground + 1) * width + x] = TDS_BENCH_BLOCK_DECOR;
+		}
+	}
+
+	for (int i = 0; i < width * height / 128; ++i) {
+		int x = _tds_bench_rand() % width, y = height / 2 + _tds_bench_rand() % (height / 2);
+		int w = 2 + _tds_bench_rand() % 8;
+
+		for (int j = x; j < x + w && j < width; ++j) {
+			output[y * width + j] = TDS_BENCH_BLOCK_SOLID;
+		}
+	}
+
+	return output;
+}
+
+static void _tds_bench_write_fixtures(void) {
+	FILE* fd = fopen("bench.lua", "w");
+
+	if (fd) {
+		fprintf(fd, "headless = true\nworker_threads = 0\n");
+		fclose(fd);
+	}
+
+	mkdir("res", 0755);
+	mkdir("res/strings", 0755);
+	mkdir("res/maps", 0755);
+
+	fd = fopen("res/strings/bench", "w");
+
+	if (fd) {
+		for (int i = 0; i < TDS_BENCH_STRINGDB_ENTRIES; ++i) {
+			fprintf(fd, "@bench_entry_%d\n", i);
+
+			for (int j = 0; j < 4; ++j) {
+				fprintf(fd, "#%d\n:Benchmark string %d.%d\n:Alternate string %d.%d\n", j, i, j, i, j);
+			}
+		}
+
+		fclose(fd);
+	}
+
+	fd = fopen("res/maps/bench.tmx", "w");
+
+	if (!fd) {
+		return;
+	}
+
+	uint8_t* blocks = _tds_bench_make_grid(TDS_BENCH_MAP_SIZE, TDS_BENCH_MAP_SIZE);
+
+	fprintf(fd, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"32\" tileheight=\"32\">\n", TDS_BENCH_MAP_SIZE, TDS_BENCH_MAP_SIZE);
+	fprintf(fd, " <layer name=\"world\" width=\"%d\" height=\"%d\">\n  <data encoding=\"csv\">\n", TDS_BENCH_MAP_SIZE, TDS_BENCH_MAP_SIZE);
+
+	/* Map rows are stored top to bottom. */
+	for (int y = TDS_BENCH_MAP_SIZE - 1; y >= 0; --y) {
+		for (int x = 0; x < TDS_BENCH_MAP_SIZE; ++x) {
+			fprintf(fd, "%d,", blocks[y * TDS_BENCH_MAP_SIZE + x]);
+		}
+
+		fprintf(fd, "\n");
+	}
+
+	fprintf(fd, "  </data>\n </layer>\n <objectgroup name=\"objects\">\n");
+
+	for (int i = 0; i < TDS_BENCH_MAP_OBJECTS; ++i) {
+		fprintf(fd, "  <object type=\"obj_bench\" x=\"%u\" y=\"%u\" width=\"32\" height=\"64\">\n   <properties>\n", _tds_bench_rand() % (TDS_BENCH_MAP_SIZE * 32), _tds_bench_rand() % (TDS_BENCH_MAP_SIZE * 32));
+		fprintf(fd, "    <property name=\"i0\" value=\"%d\"/>\n    <property name=\"f1\" value=\"%.2f\"/>\n    <property name=\"s2\" value=\"bench_target_%d\"/>\n", i, _tds_bench_randf(0.0f, 10.0f), i % 8);
+		fprintf(fd, "   </properties>\n  </object>\n");
+	}
+
+	fprintf(fd, " </objectgroup>\n</map>\n");
+	fclose(fd);
+
+	tds_free(blocks);
+}
+
+static void _tds_bench_handle_get(void* data) {
+	struct tds_bench_handle_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_HANDLE_COUNT; ++i) {
+		if (!tds_handle_manager_get(bench->hmgr, bench->handles[i])) {
+			fprintf(stderr, "tds_bench: handle lookup failed\n");
+		}
+	}
+}
+
+static void _tds_bench_handle_churn(void* data) {
+	/* Release every handle and allocate a new one in its slot, the pattern of objects dying and spawning. */
+	struct tds_bench_handle_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_HANDLE_COUNT; ++i) {
+		tds_handle_manager_set(bench->hmgr, bench->handles[i], NULL);
+		bench->handles[i] = tds_handle_manager_get_new(bench->hmgr, &bench->dummy);
+	}
+}
+
+static void _tds_bench_quadtree_insert(void* data) {
+	struct tds_bench_quadtree_data* bench = data;
+	struct tds_quadtree* tree = tds_quadtree_create(-64.0f, 64.0f, 64.0f, -64.0f);
+
+	for (int i = 0; i < TDS_BENCH_QUADTREE_COUNT; ++i) {
+		tds_quadtree_insert(tree, bench->boxes[i * 4], bench->boxes[i * 4 + 1], bench->boxes[i * 4 + 2], bench->boxes[i * 4 + 3], bench->boxes + i * 4);
+	}
+
+	tds_quadtree_free(tree);
+}
+
+static void _tds_bench_quadtree_walk(void* data) {
+	struct tds_bench_quadtree_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_QUERY_COUNT; ++i) {
+		float x = bench->boxes[(i % TDS_BENCH_QUADTREE_COUNT) * 4], y = bench->boxes[(i % TDS_BENCH_QUADTREE_COUNT) * 4 + 3];
+		tds_quadtree_walk(bench->tree, x - 2.0f, x + 2.0f, y + 2.0f, y - 2.0f, bench, _tds_bench_quadtree_walk_callback);
+	}
+}
+
+static void _tds_bench_quadtree_walk_callback(void* usr, void* data) {
+	(void) data;
+	((struct tds_bench_quadtree_data*) usr)->visited++;
+}
+
+static void _tds_bench_world_hblocks(void* data) {
+	tds_world_generate_hblocks(((struct tds_bench_world_data*) data)->world);
+}
+
+static void _tds_bench_world_segments(void* data) {
+	tds_world_generate_segments(((struct tds_bench_world_data*) data)->world);
+}
+
+static void _tds_bench_world_set_block(void* data) {
+	/* Dig a tile out of the terrain and put it back, the editor and destructible terrain pattern. */
+	struct tds_bench_world_data* bench = data;
+	int x = bench->width / 2, y = bench->height / 4;
+
+	tds_world_set_block(bench->world, x, y, 0);
+	tds_world_set_block(bench->world, x, y, bench->blocks[y * bench->width + x]);
+}
+
+static void _tds_bench_world_overlap(void* data) {
+	struct tds_bench_overlap_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_QUERY_COUNT; ++i) {
+		tds_object_set_pos(bench->obj, bench->positions[i * 2], bench->positions[i * 2 + 1]);
+		bench->hits += tds_world_get_overlap_fast(bench->world, bench->obj, NULL, NULL, NULL, NULL, 0, TDS_BLOCK_TYPE_SOLID, 0) != 0;
+	}
+}
+
+static void _tds_bench_world_overlap_batch(void* data) {
+	struct tds_bench_overlap_data* bench = data;
+	bench->hits += tds_world_get_overlap_batch(bench->world, bench->queries, TDS_BENCH_QUERY_COUNT, 0, TDS_BLOCK_TYPE_SOLID, 0);
+}
+
+static void _tds_bench_world_sweep(void* data) {
+	/* One tick of a fast falling, running object : about a tile sideways and two down. */
+	struct tds_bench_overlap_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_QUERY_COUNT; ++i) {
+		bench->hits += tds_world_sweep(bench->world, bench->positions[i * 2], bench->positions[i * 2 + 1], 0.4f, 0.9f, 0.5f, -1.0f, 0, TDS_BLOCK_TYPE_SOLID, 0, NULL);
+	}
+}
+
+static void _tds_bench_map_parse(void* data) {
+	tds_engine_load(data, "bench.tmx");
+}
+
+static void _tds_bench_stringdb_get(void* data) {
+	struct tds_bench_stringdb_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_QUERY_COUNT; ++i) {
+		bench->total_len += tds_stringdb_get(bench->db, bench->ids[i], bench->id_lens[i], i & 3)->len;
+	}
+}
+
+static void _tds_bench_param_get(void* data) {
+	struct tds_bench_param_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_PARAM_COUNT * 2; ++i) {
+		int* value = tds_object_get_ipart(bench->obj, i);
+		bench->sum += value ? *value : 0;
+	}
+}
+
+static void _tds_bench_param_set(void* data) {
+	struct tds_bench_param_data* bench = data;
+
+	for (int i = 0; i < TDS_BENCH_PARAM_COUNT; ++i) {
+		tds_object_set_ipart(bench->obj, i * 2, (int) bench->sum + i);
+	}
+}
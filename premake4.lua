@@ -12,7 +12,7 @@ solution "tds"
 
 		configuration "linux"
 			includedirs { "/usr/include/freetype2" }
-			links { "m", "GL", "dl", "glfw", "openal", "lua", "freetype" }
+			links { "m", "GL", "dl", "glfw", "openal", "lua", "freetype", "pthread" }
 			newaction {
 				trigger = "install",
 				description = "Install libtds",
@@ -30,7 +30,7 @@ solution "tds"
 
 		configuration "debug"
 			defines { "TDS_MEMORY_DEBUG", "TDS_PROFILE_ENABLE" }
-			links { "m", "GL", "dl", "glfw", "openal", "lua", "freetype" }
+			links { "m", "GL", "dl", "glfw", "openal", "lua", "freetype", "pthread" }
 			flags { "Symbols" }
 			targetname "tds_debug"
 
@@ -38,3 +38,26 @@ solution "tds"
 			defines { "TDS_IGNORE_SIGFPE" }
 			flags { "Optimize", "EnableSSE", "EnableSSE2", "ExtraWarnings" }
 			targetname "tds"
+
+	project "tds_bench"
+		kind "ConsoleApp"
+		language "C"
+		targetdir ""
+
+		-- The benchmarks build their own copy of the engine with debug logging compiled out.
+		files { "src/**.h", "src/**.c", "bench/**.c" }
+		defines { "TDS_LOG_LEVEL=TDS_LOG_WARNING" }
+
+		configuration "linux"
+			includedirs { "/usr/include/freetype2" }
+			links { "m", "GL", "dl", "glfw", "openal", "lua", "freetype", "pthread" }
+
+		configuration "debug"
+			defines { "TDS_MEMORY_DEBUG" }
+			flags { "Symbols" }
+			targetname "tds_bench_debug"
+
+		configuration "release"
+			defines { "TDS_IGNORE_SIGFPE" }
+			flags { "Optimize", "EnableSSE", "EnableSSE2", "ExtraWarnings" }
+			targetname "tds_bench"
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "linmath.h"
+
+#include <math.h>
+
+/* 2D affine transforms, stored as the top two rows of a 3x3 matrix :
+ * x' = a * x + c * y + tx
+ * y' = b * x + d * y + ty
+ * Objects and sprites cache one of these each and only rebuild it when their inputs change. */
+
+struct tds_affine {
+	float a, b, c, d, tx, ty;
+};
+
+static inline void tds_affine_rotate_translate(struct tds_affine* out, float angle, float x, float y) {
+	/* Rotation applied first, then translation. */
+	float s = sinf(angle), c = cosf(angle);
+
+	out->a = c;
+	out->b = s;
+	out->c = -s;
+	out->d = c;
+	out->tx = x;
+	out->ty = y;
+}
+
+static inline void tds_affine_mul(struct tds_affine* out, const struct tds_affine* l, const struct tds_affine* r) {
+	/* out = l * r, out must not alias either operand. */
+	out->a = l->a * r->a + l->c * r->b;
+	out->b = l->b * r->a + l->d * r->b;
+	out->c = l->a * r->c + l->c * r->d;
+	out->d = l->b * r->c + l->d * r->d;
+	out->tx = l->a * r->tx + l->c * r->ty + l->tx;
+	out->ty = l->b * r->tx + l->d * r->ty + l->ty;
+}
+
+static inline void tds_affine_apply_mat4x4(mat4x4 out, mat4x4 M, const struct tds_affine* t, float z) {
+	/* out = M * t, with t lifted to a 4x4 matrix translating by z. Only touches the columns the affine actually changes. */
+	for (int i = 0; i < 4; ++i) {
+		out[0][i] = M[0][i] * t->a + M[1][i] * t->b;
+		out[1][i] = M[0][i] * t->c + M[1][i] * t->d;
+		out[2][i] = M[2][i];
+		out[3][i] = M[0][i] * t->tx + M[1][i] * t->ty + M[2][i] * z + M[3][i];
+	}
+}
@@ -18,6 +18,11 @@ void tds_block_map_free(struct tds_block_map* ptr) {
 }
 
 void tds_block_map_add(struct tds_block_map* ptr, struct tds_texture* tex, int flags, uint8_t id) {
+	/* hblock texcoords count tiles, so block textures repeat across the run (and up merged rectangles). */
+	if (tex) {
+		tds_texture_set_wrap(tex, 1, 1);
+	}
+
 	ptr->buffer[id].texture = tex;
 	ptr->buffer[id].flags = flags;
 }
@@ -2,6 +2,7 @@
 #include "memory.h"
 #include "log.h"
 #include "engine.h"
+#include "object.h"
 
 #include <math.h>
 
@@ -51,3 +52,7 @@ void tds_camera_set_raw(struct tds_camera* ptr, float width, float height, float
 
 	mat4x4_mul(ptr->mat_transform, ortho, translate);
 }
+
+void tds_camera_follow(struct tds_camera* ptr, struct tds_object* obj) {
+	tds_camera_set_raw(ptr, ptr->width, ptr->height, tds_object_get_render_x(obj), tds_object_get_render_y(obj));
+}
@@ -3,6 +3,8 @@
 #include "display.h"
 #include "linmath.h"
 
+struct tds_object;
+
 struct tds_camera {
 	float x, y, z, angle;
 	float width, height;
@@ -16,3 +18,4 @@ void tds_camera_free(struct tds_camera* ptr);
 
 void tds_camera_set(struct tds_camera* ptr, float camera_size, float x, float y);
 void tds_camera_set_raw(struct tds_camera* ptr, float width, float height, float x, float y);
+void tds_camera_follow(struct tds_camera* ptr, struct tds_object* obj); /* Centers on the object's interpolated position, call it every drawn frame. */
@@ -2,6 +2,7 @@
 #include "log.h"
 
 #include <time.h>
+#include <errno.h>
 
 tds_clock_point tds_clock_get_point(void) {
 	tds_clock_point output;
@@ -19,3 +20,29 @@ double tds_clock_get_ms(tds_clock_point rel) {
 
 	return ms;
 }
+
+tds_clock_point tds_clock_add_ms(tds_clock_point point, double ms) {
+	long long nsec = (long long) point.tv_nsec + (long long) (ms * 1000000.0);
+
+	point.tv_sec += nsec / 1000000000LL;
+	nsec %= 1000000000LL;
+
+	if (nsec < 0) {
+		nsec += 1000000000LL;
+		point.tv_sec--;
+	}
+
+	point.tv_nsec = nsec;
+
+	return point;
+}
+
+void tds_clock_sleep_until(tds_clock_point target) {
+	tds_clock_point wake = tds_clock_add_ms(target, -TDS_CLOCK_SPIN_MS);
+
+	if (tds_clock_get_ms(wake) < 0.0) {
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR);
+	}
+
+	while (tds_clock_get_ms(target) < 0.0);
+}
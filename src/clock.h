@@ -2,7 +2,14 @@
 
 #include <sys/time.h>
 
+#define TDS_CLOCK_SPIN_MS 1.0 /* How long before a deadline sleeping stops and spinning takes over. */
+
 typedef struct timespec tds_clock_point;
 
 tds_clock_point tds_clock_get_point(void);
 double tds_clock_get_ms(tds_clock_point rel);
+tds_clock_point tds_clock_add_ms(tds_clock_point point, double ms);
+
+/* Hybrid wait : sleeps until shortly before the target, then spins on the clock for the last stretch.
+ * Scheduler wakeups are only accurate to a millisecond or so, the spin makes the deadline accurate to a few microseconds. */
+void tds_clock_sleep_until(tds_clock_point target);
@@ -11,19 +11,24 @@ float _tds_collision_crossz(float x1, float y1, float x2, float y2, float x3, fl
 int _tds_collision_tri(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
 
 int tds_collision_get_overlap(struct tds_object* first, struct tds_object* second) {
-	if (first->x - first->cbox_width / 2.0f > second->x + second->cbox_width / 2.0f) {
+	float first_x = tds_object_get_x(first), first_y = tds_object_get_y(first);
+	float first_w = tds_object_get_cbox_width(first), first_h = tds_object_get_cbox_height(first);
+	float second_x = tds_object_get_x(second), second_y = tds_object_get_y(second);
+	float second_w = tds_object_get_cbox_width(second), second_h = tds_object_get_cbox_height(second);
+
+	if (first_x - first_w / 2.0f > second_x + second_w / 2.0f) {
 		return 0;
 	}
 
-	if (first->x + first->cbox_width / 2.0f < second->x - second->cbox_width / 2.0f) {
+	if (first_x + first_w / 2.0f < second_x - second_w / 2.0f) {
 		return 0;
 	}
 
-	if (first->y - first->cbox_height / 2.0f > second->y + second->cbox_height / 2.0f) {
+	if (first_y - first_h / 2.0f > second_y + second_h / 2.0f) {
 		return 0;
 	}
 
-	if (first->y + first->cbox_height / 2.0f < second->y - second->cbox_height / 2.0f) {
+	if (first_y + first_h / 2.0f < second_y - second_h / 2.0f) {
 		return 0;
 	}
 
@@ -31,19 +36,22 @@ int tds_collision_get_overlap(struct tds_object* first, struct tds_object* secon
 }
 
 int tds_collision_get_point_overlap(struct tds_object* ptr, float x, float y) {
-	if (x < ptr->x - ptr->cbox_width / 2.0f) {
+	float obj_x = tds_object_get_x(ptr), obj_y = tds_object_get_y(ptr);
+	float obj_w = tds_object_get_cbox_width(ptr), obj_h = tds_object_get_cbox_height(ptr);
+
+	if (x < obj_x - obj_w / 2.0f) {
 		return 0;
 	}
 
-	if (x > ptr->x + ptr->cbox_width / 2.0f) {
+	if (x > obj_x + obj_w / 2.0f) {
 		return 0;
 	}
 
-	if (y < ptr->y - ptr->cbox_height / 2.0f) {
+	if (y < obj_y - obj_h / 2.0f) {
 		return 0;
 	}
 
-	if (y > ptr->y + ptr->cbox_height / 2.0f) {
+	if (y > obj_y + obj_h / 2.0f) {
 		return 0;
 	}
 
@@ -191,7 +191,7 @@ void _tds_console_execute(struct tds_console* ptr) {
 		tds_console_print(ptr, "]\n");
 
 		float x_f = strtof(x, NULL), y_f = strtof(y, NULL);
-		struct tds_object* new_object = tds_object_create(obj_type, tds_engine_global->object_buffer, tds_engine_global->sc_handle, x_f, y_f, 0.0f, NULL);
+		struct tds_object* new_object = tds_engine_spawn(tds_engine_global, obj_type, x_f, y_f, 0.0f, NULL, 0);
 		tds_console_print(ptr, "created object\n");
 
 		if (tds_editor_get_mode() == TDS_EDITOR_MODE_OBJECTS) {
@@ -1,12 +1,19 @@
 #include "display.h"
 #include "memory.h"
 #include "log.h"
+#include "headless.h"
 
 static void _tds_display_err_callback(int code, const char* msg);
 
 struct tds_display* tds_display_create(struct tds_display_desc desc) {
 	struct tds_display* output = tds_malloc(sizeof(struct tds_display));
 
+	if (tds_headless) {
+		output->win_handle = NULL;
+		output->desc = desc;
+		return output;
+	}
+
 	glfwTerminate();
 
 	if (!glfwInit()) {
@@ -48,24 +55,46 @@ struct tds_display* tds_display_create(struct tds_display_desc desc) {
 }
 
 void tds_display_free(struct tds_display* ptr) {
-	glfwDestroyWindow(ptr->win_handle);
-	glfwTerminate();
+	if (ptr->win_handle) {
+		glfwDestroyWindow(ptr->win_handle);
+		glfwTerminate();
+	}
 
 	tds_free(ptr);
 }
 
 void tds_display_swap(struct tds_display* ptr) {
+	if (!ptr->win_handle) {
+		return;
+	}
+
 	glfwSwapBuffers(ptr->win_handle);
 }
 
 void tds_display_update(struct tds_display* ptr) {
+	if (!ptr->win_handle) {
+		return;
+	}
+
 	glfwPollEvents();
 }
 
 int tds_display_get_close(struct tds_display* ptr) {
+	if (!ptr->win_handle) {
+		return 0;
+	}
+
 	return glfwWindowShouldClose(ptr->win_handle);
 }
 
+int tds_display_get_focused(struct tds_display* ptr) {
+	if (!ptr->win_handle) {
+		return 1;
+	}
+
+	return glfwGetWindowAttrib(ptr->win_handle, GLFW_FOCUSED) && !glfwGetWindowAttrib(ptr->win_handle, GLFW_ICONIFIED);
+}
+
 void _tds_display_err_callback(int code, const char* msg) {
 	tds_logf(TDS_LOG_CRITICAL, "GLFW error %d : [%s]\n", code, msg);
 }
@@ -18,3 +18,4 @@ void tds_display_free(struct tds_display* ptr);
 void tds_display_swap(struct tds_display* ptr);
 void tds_display_update(struct tds_display* ptr);
 int tds_display_get_close(struct tds_display* ptr);
+int tds_display_get_focused(struct tds_display* ptr); /* 0 when the window is unfocused or minimized. */
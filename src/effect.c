@@ -4,6 +4,7 @@
 #include "render.h"
 #include "camera.h"
 #include "engine.h"
+#include "headless.h"
 
 #include <GLXW/glxw.h>
 #include <stdlib.h>
@@ -54,6 +55,10 @@ void tds_effect_update(struct tds_effect* ptr) {
 }
 
 void tds_effect_render(struct tds_effect* ptr, struct tds_shader* shader) {
+	if (tds_headless) {
+		return;
+	}
+
 	struct tds_effect_instance* cur = ptr->list;
 
 	mat4x4 final, transform;
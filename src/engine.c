@@ -10,6 +10,7 @@
 #include "log.h"
 #include "msg.h"
 #include "yxml.h"
+#include "headless.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -19,9 +20,18 @@
 #include "objects/objects.h"
 
 #define TDS_ENGINE_TIMESTEP 120.0f
+#define TDS_ENGINE_FPS_CAP_UNFOCUSED 30 /* Default frame cap while the window is unfocused or minimized, configurable with fps_cap_unfocused. */
+#define TDS_ENGINE_MAX_STEPS 8 /* Default cap on update ticks per frame, configurable with max_steps_per_frame. */
+#define TDS_ENGINE_QUEUE_INITIAL_SIZE 64
+#define TDS_ENGINE_PARALLEL_CHUNK 32
 
 struct tds_engine* tds_engine_global = NULL;
 
+static void _tds_engine_queue_push(struct tds_engine_object_queue* queue, struct tds_object* obj);
+static void _tds_engine_parallel_update(void* data, int start, int end);
+static void _tds_engine_anim_update(struct tds_engine* ptr);
+static void _tds_engine_broadcast_types(struct tds_engine* ptr, struct tds_object_type_cache_subscription* sub, int msg, void* param);
+
 struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 	if (tds_engine_global) {
 		tds_logf(TDS_LOG_CRITICAL, "Only one engine can exist!\n");
@@ -32,15 +42,38 @@ struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 
 	tds_engine_global = output;
 
-	srand(time(NULL));
-
 	struct tds_display_desc display_desc;
 
 	output->desc = desc;
 	output->object_list = NULL;
+	output->object_list_capacity = 0;
+
+	output->spawn_queue.buffer = output->destroy_queue.buffer = NULL;
+	output->spawn_queue.size = output->destroy_queue.size = 0;
+	output->spawn_queue.capacity = output->destroy_queue.capacity = 0;
+
+	output->parallel_list.buffer = NULL;
+	output->parallel_list.size = output->parallel_list.capacity = 0;
+
+	output->anim_list.buffer = NULL;
+	output->anim_list.size = output->anim_list.capacity = 0;
+
+	output->broadcast_handles = NULL;
+	output->broadcast_size = output->broadcast_capacity = 0;
+
+	output->msg_queue.buffer = NULL;
+	output->msg_queue.size = output->msg_queue.capacity = 0;
+
+	output->parallel_phase = 0;
+	pthread_mutex_init(&output->queue_lock, NULL);
+	pthread_mutex_init(&output->param_strings_lock, NULL);
 
 	output->enable_update = output->enable_draw = 1;
 
+	output->state.time_ms = 0.0;
+	output->state.tick_count = 0;
+	output->state.alpha = 0.0f;
+	output->state.dropped_steps = 0;
 	output->state.fps = 0.0f;
 	output->state.entity_maxindex = 0;
 	output->request_load = NULL;
@@ -50,12 +83,50 @@ struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 	struct tds_script* engine_conf = tds_script_create(desc.config_filename);
 	tds_logf(TDS_LOG_MESSAGE, "Executed engine configuration.\n");
 
+	/* Headless mode has to be decided before any GL or AL resource is created. */
+	output->headless = tds_headless = desc.headless || tds_script_get_var_bool(engine_conf, "headless", 0);
+	output->tick_limit = tds_script_get_var_int(engine_conf, "tick_limit", 0);
+
+	if (output->headless) {
+		tds_logf(TDS_LOG_MESSAGE, "Running headless, display, rendering and sound are disabled.\n");
+	}
+
+	/* The replay decides the random seed, so it is opened before anything can call rand(). */
+	const char* replay_play = desc.replay_play_filename ? desc.replay_play_filename : tds_script_get_var_string(engine_conf, "replay_play", NULL);
+	const char* replay_record = desc.replay_record_filename ? desc.replay_record_filename : tds_script_get_var_string(engine_conf, "replay_record", NULL);
+
+	output->replay_handle = NULL;
+	output->seed = time(NULL);
+
+	if (replay_play) {
+		output->replay_handle = tds_replay_create_play(replay_play);
+	} else if (replay_record) {
+		output->replay_handle = tds_replay_create_record(replay_record, output->seed);
+	}
+
+	if (output->replay_handle) {
+		output->seed = output->replay_handle->seed;
+	}
+
+	srand(output->seed);
+
 	tds_signal_init();
 	tds_logf(TDS_LOG_MESSAGE, "Registered signal handlers.\n");
 
 	output->profile_handle = tds_profile_create();
 	tds_logf(TDS_LOG_MESSAGE, "Initialized engine profiler.\n");
 
+	output->worker_pool_handle = tds_worker_pool_create(tds_script_get_var_int(engine_conf, "worker_threads", -1));
+	tds_logf(TDS_LOG_MESSAGE, "Initialized worker pool with %d threads.\n", output->worker_pool_handle->thread_count);
+
+	output->max_steps = tds_script_get_var_int(engine_conf, "max_steps_per_frame", TDS_ENGINE_MAX_STEPS);
+
+	if (output->max_steps < 1) {
+		output->max_steps = 1;
+	}
+
+	output->world_merge_rects = tds_script_get_var_bool(engine_conf, "world_merge_rects", 0);
+
 	tds_profile_push(output->profile_handle, "Init sequence");
 
 	output->stringdb_handle = tds_stringdb_create(desc.stringdb_filename);
@@ -68,6 +139,9 @@ struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 	display_desc.vsync = tds_script_get_var_int(engine_conf, "verticalsync", 0);
 	display_desc.msaa = tds_script_get_var_int(engine_conf, "msaa", 0);
 
+	output->fps_cap = tds_script_get_var_int(engine_conf, "fps_cap", 0);
+	output->fps_cap_unfocused = tds_script_get_var_int(engine_conf, "fps_cap_unfocused", TDS_ENGINE_FPS_CAP_UNFOCUSED);
+
 	tds_logf(TDS_LOG_MESSAGE, "Loaded display description. Video mode : %d by %d, FS %s, VSYNC %d intervals, MSAA %d\n", display_desc.width, display_desc.height, display_desc.fs ? "on" : "off", display_desc.vsync, display_desc.msaa);
 	output->display_handle = tds_display_create(display_desc);
 	tds_logf(TDS_LOG_MESSAGE, "Created display.\n");
@@ -85,9 +159,15 @@ struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 	output->otc_handle = tds_object_type_cache_create();
 	tds_logf(TDS_LOG_MESSAGE, "Initialized object type cache.\n");
 
-	output->object_buffer = tds_handle_manager_create(1024);
+	output->param_strings = tds_registry_create();
+	tds_logf(TDS_LOG_MESSAGE, "Initialized parameter string pool.\n");
+
+	output->object_buffer = tds_handle_manager_create(1024); /* Initial capacity, the buffer grows as needed. */
 	tds_logf(TDS_LOG_MESSAGE, "Initialized object buffer.\n");
 
+	output->kinematics_handle = tds_kinematics_create(1024);
+	tds_logf(TDS_LOG_MESSAGE, "Initialized kinematics store.\n");
+
 	output->ft_handle = tds_ft_create();
 	tds_logf(TDS_LOG_MESSAGE, "Initialized FreeType2 context.\n");
 
@@ -135,6 +215,7 @@ struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 
 	for (int i = 0; i < TDS_MAX_WORLD_LAYERS; ++i) {
 		output->world_buffer[i] = tds_world_create();
+		tds_world_set_merge_rects(output->world_buffer[i], output->world_merge_rects);
 		tds_logf(TDS_LOG_MESSAGE, "Initialized world subsystem for layer %d.\n", i);
 	}
 
@@ -191,6 +272,10 @@ struct tds_engine* tds_engine_create(struct tds_engine_desc desc) {
 
 	output->enable_fps = 0;
 
+	if (output->headless) {
+		output->enable_draw = 0;
+	}
+
 	/* Free configs */
 	tds_script_free(engine_conf);
 	tds_logf(TDS_LOG_MESSAGE, "Done initializing everything.\n");
@@ -219,6 +304,17 @@ void tds_engine_free(struct tds_engine* ptr) {
 
 	tds_engine_flush_objects(ptr);
 
+	tds_free(ptr->spawn_queue.buffer);
+	tds_free(ptr->destroy_queue.buffer);
+	tds_free(ptr->parallel_list.buffer);
+	tds_free(ptr->anim_list.buffer);
+	tds_free(ptr->broadcast_handles);
+	tds_free(ptr->msg_queue.buffer);
+
+	pthread_mutex_destroy(&ptr->queue_lock);
+	pthread_mutex_destroy(&ptr->param_strings_lock);
+	tds_worker_pool_free(ptr->worker_pool_handle);
+
 	tds_profile_output(ptr->profile_handle);
 	tds_profile_flush(ptr->profile_handle);
 
@@ -236,6 +332,10 @@ void tds_engine_free(struct tds_engine* ptr) {
 		tds_free(ptr->state.mapname);
 	}
 
+	if (ptr->replay_handle) {
+		tds_replay_free(ptr->replay_handle);
+	}
+
 	tds_input_free(ptr->input_handle);
 	tds_input_map_free(ptr->input_map_handle);
 	tds_key_map_free(ptr->key_map_handle);
@@ -253,6 +353,8 @@ void tds_engine_free(struct tds_engine* ptr) {
 	tds_sound_manager_free(ptr->sound_manager_handle);
 	tds_effect_free(ptr->effect_handle);
 	tds_handle_manager_free(ptr->object_buffer);
+	tds_kinematics_free(ptr->kinematics_handle);
+	tds_registry_free(ptr->param_strings);
 	tds_console_free(ptr->console_handle);
 	tds_savestate_free(ptr->savestate_handle);
 	tds_stringdb_free(ptr->stringdb_handle);
@@ -279,17 +381,21 @@ void tds_engine_run(struct tds_engine* ptr) {
 
 	unsigned long frame_count = 0;
 	tds_clock_point init_point = tds_clock_get_point();
+	tds_clock_point frame_deadline = init_point;
 
 	const int fps_graph_cnt = 32;
 	float fps_max = 0.0f, fps_min = 1000.0f, fps_graph[fps_graph_cnt];
 	int fps_graph_write = 0;
 
+	/* Objects spawned during init or map load join the loops before the first tick. */
+	tds_engine_apply_queues(ptr);
+
 	while (running && ptr->run_flag) {
 		running &= !tds_display_get_close(ptr->display_handle);
 
 		double delta_ms = tds_clock_get_ms(dt_point);
 		dt_point = tds_clock_get_point();
-		accumulator += delta_ms;
+		accumulator += ptr->headless ? timestep_ms : delta_ms;
 
 		frame_count++;
 
@@ -316,33 +422,103 @@ void tds_engine_run(struct tds_engine* ptr) {
 
 		tds_profile_push(ptr->profile_handle, "Update cycle");
 
-		while (accumulator >= timestep_ms) {
+		int steps = 0;
+
+		while (accumulator >= timestep_ms && steps < ptr->max_steps) {
 			accumulator -= timestep_ms;
 			accum_frames++;
+			steps++;
+
+			tds_kinematics_snapshot(ptr->kinematics_handle, ptr->object_buffer->max_index);
 
 			/* Run game update logic. */
 			/* Even if updating is disabled, we still want to run down the accumulator. */
 
 			tds_input_update(ptr->input_handle);
 
+			if (ptr->replay_handle && !tds_replay_tick(ptr->replay_handle, ptr->input_handle)) {
+				ptr->run_flag = 0;
+				break;
+			}
+
+			ptr->state.time_ms += timestep_ms;
+			ptr->state.tick_count++;
+
 			if (ptr->enable_update) {
+				ptr->parallel_list.size = 0;
+
+				for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
+					struct tds_object* target = (struct tds_object*) ptr->object_buffer->buffer[i].data;
+
+					if (!target || target->spawn_pending || target->destroy_pending) {
+						continue;
+					}
+
+					if (target->parallel_update && target->func_update) {
+						_tds_engine_queue_push(&ptr->parallel_list, target);
+					}
+				}
+
+				/* Parallel-safe objects update first across the pool, then their messages are delivered before the serial objects run. */
+				ptr->parallel_phase = 1;
+				tds_worker_pool_run(ptr->worker_pool_handle, ptr->parallel_list.buffer, ptr->parallel_list.size, TDS_ENGINE_PARALLEL_CHUNK, _tds_engine_parallel_update);
+				ptr->parallel_phase = 0;
+
+				for (int i = 0; i < ptr->parallel_list.size; ++i) {
+					tds_object_update_sndsrc(ptr->parallel_list.buffer[i]);
+				}
+
+				tds_engine_deliver_msgs(ptr);
+
 				for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
 					struct tds_object* target = (struct tds_object*) ptr->object_buffer->buffer[i].data;
 
-					if (!target) {
+					if (!target || target->spawn_pending || target->destroy_pending) {
+						continue;
+					}
+
+					if (target->parallel_update && target->func_update) {
 						continue;
 					}
 
 					tds_object_update(target);
 				}
 
+				tds_kinematics_integrate(ptr->kinematics_handle, ptr->object_buffer->max_index);
+
 				tds_effect_update(ptr->effect_handle);
 				tds_module_container_update(ptr->module_container_handle);
 			}
+
+			/* Animations keep running while updates are disabled, as they did when they were advanced on draw. */
+			_tds_engine_anim_update(ptr);
+
+			tds_engine_apply_queues(ptr);
+
+			if (ptr->tick_limit && ptr->state.tick_count >= ptr->tick_limit) {
+				tds_logf(TDS_LOG_MESSAGE, "Reached tick limit (%lu ticks), stopping.\n", ptr->tick_limit);
+				ptr->run_flag = 0;
+				break;
+			}
 		}
 
 		tds_profile_pop(ptr->profile_handle);
 
+		/* After a long frame (map load, shader compile) the leftover time is dropped instead of caught up on later frames.
+		 * The remainder within the current step is kept so the timestep phase does not jump. */
+		if (accumulator >= timestep_ms) {
+			unsigned long dropped = (unsigned long) (accumulator / timestep_ms);
+
+			ptr->state.dropped_steps += dropped;
+			accumulator -= dropped * timestep_ms;
+
+			tds_logf(TDS_LOG_DEBUG, "Dropped %lu update steps after a long frame (%lu total).\n", dropped, ptr->state.dropped_steps);
+		}
+
+		ptr->state.alpha = ptr->kinematics_handle->alpha = (float) (accumulator / timestep_ms);
+
+		tds_sound_manager_update(ptr->sound_manager_handle);
+
 		/* Run game draw logic. */
 		tds_render_flat_clear(ptr->render_flat_world_handle);
 		tds_render_flat_clear(ptr->render_flat_overlay_handle);
@@ -354,12 +530,14 @@ void tds_engine_run(struct tds_engine* ptr) {
 			for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
 				struct tds_object* target = (struct tds_object*) ptr->object_buffer->buffer[i].data;
 
-				if (!target) {
+				if (!target || target->spawn_pending || target->destroy_pending) {
 					continue;
 				}
 
 				tds_object_draw(target);
 			}
+
+			tds_engine_apply_queues(ptr);
 		}
 
 		tds_profile_pop(ptr->profile_handle);
@@ -374,8 +552,8 @@ void tds_engine_run(struct tds_engine* ptr) {
 			char fps_buf[12] = {0};
 			snprintf(fps_buf, sizeof fps_buf, "fps %d", (int) ptr->state.fps);
 
-			char accum_buf[24] = {0};
-			snprintf(accum_buf, sizeof accum_buf, "accumulator ms %d", (int) accumulator);
+			char accum_buf[48] = {0};
+			snprintf(accum_buf, sizeof accum_buf, "accumulator ms %d dropped %lu", (int) accumulator, ptr->state.dropped_steps);
 
 			tds_render_flat_text(ptr->render_flat_overlay_handle, ptr->font_debug, fps_buf, strlen(fps_buf), -1.0f, -0.9f, TDS_RENDER_LALIGN, NULL);
 
@@ -416,6 +594,23 @@ void tds_engine_run(struct tds_engine* ptr) {
 			tds_free(ptr->request_load);
 			ptr->request_load = NULL;
 		}
+
+		/* Frame limiter. Deadlines advance by whole periods so pacing does not drift; after a long frame the schedule restarts from now. */
+		int fps_cap = tds_display_get_focused(ptr->display_handle) ? ptr->fps_cap : ptr->fps_cap_unfocused;
+
+		if (fps_cap > 0) {
+			double period_ms = 1000.0 / (double) fps_cap;
+
+			frame_deadline = tds_clock_add_ms(frame_deadline, period_ms);
+
+			if (tds_clock_get_ms(frame_deadline) > period_ms) {
+				frame_deadline = tds_clock_add_ms(tds_clock_get_point(), period_ms);
+			}
+
+			tds_clock_sleep_until(frame_deadline);
+		} else {
+			frame_deadline = tds_clock_get_point();
+		}
 	}
 
 	tds_logf(TDS_LOG_MESSAGE, "Finished engine mainloop. Average framerate: %f FPS [%d frames in %f s]\n", (float) frame_count / ((float) tds_clock_get_ms(init_point) / 1000.0f), frame_count, tds_clock_get_ms(init_point) / 1000.0f);
@@ -428,43 +623,158 @@ void tds_engine_flush_objects(struct tds_engine* ptr) {
 		}
 	}
 
+	/* Every queued object was still in the buffer, so they are all gone now. */
+	ptr->spawn_queue.size = ptr->destroy_queue.size = 0;
+	ptr->msg_queue.size = 0;
+
 	tds_bg_flush(ptr->bg_handle);
 	tds_effect_flush(ptr->effect_handle);
 }
 
-struct tds_object* tds_engine_get_object_by_type(struct tds_engine* ptr, const char* typename) {
-	for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
-		if (!ptr->object_buffer->buffer[i].data) {
+struct tds_object* tds_engine_spawn(struct tds_engine* ptr, struct tds_object_type* type, float x, float y, float z, struct tds_object_param* param_list, int param_count) {
+	struct tds_object* output = tds_object_create(type, ptr->object_buffer, ptr->kinematics_handle, ptr->sc_handle, x, y, z, param_list, param_count);
+
+	output->spawn_pending = 1;
+	_tds_engine_queue_push(&ptr->spawn_queue, output);
+
+	return output;
+}
+
+void tds_engine_request_destroy(struct tds_engine* ptr, struct tds_object* obj) {
+	if (!obj) {
+		return;
+	}
+
+	pthread_mutex_lock(&ptr->queue_lock);
+
+	if (!obj->destroy_pending) {
+		obj->destroy_pending = 1;
+		_tds_engine_queue_push(&ptr->destroy_queue, obj);
+	}
+
+	pthread_mutex_unlock(&ptr->queue_lock);
+}
+
+void tds_engine_anim_track(struct tds_engine* ptr, struct tds_object* obj) {
+	/* Locked like the destroy queue : a parallel update may change its own sprite. */
+	pthread_mutex_lock(&ptr->queue_lock);
+
+	if (obj->anim_index < 0) {
+		obj->anim_index = ptr->anim_list.size;
+		_tds_engine_queue_push(&ptr->anim_list, obj);
+	}
+
+	pthread_mutex_unlock(&ptr->queue_lock);
+}
+
+void tds_engine_anim_untrack(struct tds_engine* ptr, struct tds_object* obj) {
+	pthread_mutex_lock(&ptr->queue_lock);
+
+	if (obj->anim_index >= 0) {
+		/* Swap the last entry into the hole, the list is unordered. */
+		struct tds_object* last = ptr->anim_list.buffer[--ptr->anim_list.size];
+
+		ptr->anim_list.buffer[obj->anim_index] = last;
+		last->anim_index = obj->anim_index;
+		obj->anim_index = -1;
+	}
+
+	pthread_mutex_unlock(&ptr->queue_lock);
+}
+
+void tds_engine_post_msg(struct tds_engine* ptr, struct tds_object* sender, int target, int msg, void* param) {
+	pthread_mutex_lock(&ptr->queue_lock);
+
+	if (ptr->msg_queue.size >= ptr->msg_queue.capacity) {
+		ptr->msg_queue.capacity = ptr->msg_queue.capacity ? ptr->msg_queue.capacity * 2 : TDS_ENGINE_QUEUE_INITIAL_SIZE;
+		ptr->msg_queue.buffer = tds_realloc(ptr->msg_queue.buffer, sizeof *ptr->msg_queue.buffer * ptr->msg_queue.capacity);
+	}
+
+	struct tds_engine_msg* entry = ptr->msg_queue.buffer + ptr->msg_queue.size++;
+
+	entry->sender = sender;
+	entry->target = target;
+	entry->msg = msg;
+	entry->param = param;
+
+	pthread_mutex_unlock(&ptr->queue_lock);
+}
+
+void tds_engine_deliver_msgs(struct tds_engine* ptr) {
+	/* Handlers can post more messages, those are delivered in the same pass. */
+
+	for (int i = 0; i < ptr->msg_queue.size; ++i) {
+		struct tds_engine_msg entry = ptr->msg_queue.buffer[i];
+
+		if (entry.target == TDS_ENGINE_BROADCAST) {
+			tds_engine_broadcast(ptr, entry.msg, entry.param);
 			continue;
 		}
 
-		if (!strcmp(((struct tds_object*) ptr->object_buffer->buffer[i].data)->type_name, typename)) {
-			return ptr->object_buffer->buffer[i].data;
+		struct tds_object* target = tds_handle_manager_get(ptr->object_buffer, entry.target);
+
+		if (target) {
+			tds_object_msg(target, entry.sender, entry.msg, entry.param);
 		}
 	}
 
-	return NULL;
+	ptr->msg_queue.size = 0;
 }
 
-struct tds_engine_object_list tds_engine_get_object_list_by_type(struct tds_engine* ptr, const char* typename) {
-	if (ptr->object_list) {
-		tds_free(ptr->object_list);
-		ptr->object_list = NULL;
+void tds_engine_apply_queues(struct tds_engine* ptr) {
+	/* Destroy functions can spawn or destroy more objects, so keep going until both queues settle.
+	 * Spawns are activated first, so an object spawned and destroyed in the same tick is still freed exactly once. */
+
+	tds_engine_deliver_msgs(ptr);
+
+	while (ptr->spawn_queue.size || ptr->destroy_queue.size) {
+		for (int i = 0; i < ptr->spawn_queue.size; ++i) {
+			ptr->spawn_queue.buffer[i]->spawn_pending = 0;
+		}
+
+		ptr->spawn_queue.size = 0;
+
+		for (int i = 0; i < ptr->destroy_queue.size; ++i) {
+			tds_object_free(ptr->destroy_queue.buffer[i]);
+		}
+
+		ptr->destroy_queue.size = 0;
+	}
+}
+
+struct tds_object* tds_engine_get_object_by_type(struct tds_engine* ptr, const char* typename) {
+	struct tds_object_type* type = tds_object_type_cache_get(ptr->otc_handle, typename);
+
+	if (!type) {
+		return NULL;
 	}
 
+	return type->instance_head;
+}
+
+struct tds_engine_object_list tds_engine_get_object_list_by_type(struct tds_engine* ptr, const char* typename) {
+	return tds_engine_get_object_list_by_type_id(ptr, tds_object_type_cache_find(ptr->otc_handle, typename));
+}
+
+struct tds_engine_object_list tds_engine_get_object_list_by_type_id(struct tds_engine* ptr, int type_id) {
+	/* The per-type instance list makes this O(matches). The output buffer only grows, so steady-state calls do not allocate. */
 	struct tds_engine_object_list output;
+	struct tds_object_type* type = tds_object_type_cache_get_by_id(ptr->otc_handle, type_id);
 
 	output.size = 0;
+	output.buffer = ptr->object_list;
 
-	for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
-		if (!ptr->object_buffer->buffer[i].data) {
-			continue;
-		}
+	if (!type) {
+		return output;
+	}
 
-		if (!strcmp(((struct tds_object*) ptr->object_buffer->buffer[i].data)->type_name, typename)) {
-			ptr->object_list = tds_realloc(ptr->object_list, sizeof(struct tds_object*) * ++output.size);
-			ptr->object_list[output.size - 1] = (struct tds_object*) ptr->object_buffer->buffer[i].data;
-		}
+	if (type->instance_count > ptr->object_list_capacity) {
+		ptr->object_list_capacity = type->instance_count * 2;
+		ptr->object_list = tds_realloc(ptr->object_list, sizeof(struct tds_object*) * ptr->object_list_capacity);
+	}
+
+	for (struct tds_object* cur = type->instance_head; cur; cur = cur->type_next) {
+		ptr->object_list[output.size++] = cur;
 	}
 
 	output.buffer = ptr->object_list;
@@ -522,6 +832,7 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 	for (int i = 0; i < TDS_MAX_WORLD_LAYERS; ++i) {
 		tds_world_free(ptr->world_buffer[i]);
 		ptr->world_buffer[i] = tds_world_create();
+		tds_world_set_merge_rects(ptr->world_buffer[i], ptr->world_merge_rects);
 		tds_logf(TDS_LOG_MESSAGE, "Initialized world subsystem for layer %d.\n", i);
 	}
 
@@ -533,7 +844,8 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 	int in_layer = 0, in_object = 0, in_parameter = 0, in_data = 0;
 
 	struct tds_object* cur_object = NULL;
-	struct tds_object_param* cur_object_param = NULL;
+	struct tds_object_param* cur_object_param = NULL; /* Scratch list reused for every object, copied out in one allocation on creation. */
+	int cur_object_param_count = 0, cur_object_param_capacity = 0;
 
 	char obj_type_buf[TDS_LOAD_ATTR_SIZE + 1] = {0};
 	char obj_x_buf[TDS_LOAD_ATTR_SIZE + 1] = {0};
@@ -576,6 +888,11 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 			tds_logf(TDS_LOG_WARNING, "yxml parsing error while loading %s.\n", str_filename);
 			tds_free(str_filename);
 			tds_free(ctx);
+
+			if (cur_object_param) {
+				tds_free(cur_object_param);
+			}
+
 			return;
 		}
 
@@ -727,7 +1044,7 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 					memset(obj_width_buf, 0, sizeof obj_width_buf / sizeof *obj_width_buf);
 					memset(obj_height_buf, 0, sizeof obj_height_buf / sizeof *obj_height_buf);
 
-					cur_object_param = NULL;
+					cur_object_param_count = 0;
 					break;
 				}
 
@@ -750,10 +1067,16 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 
 				tds_logf(TDS_LOG_DEBUG, "Constructing object of type [%s] (map_x %f, map_y %f, map_block_size %f, map_width %f, map_height %f, game_width %f, game_height %f, real_width %f, real_height %f, real_x %f, real_y %f\n", obj_type_buf, map_x, map_y, map_block_size, map_width, map_height, game_width, game_height, real_width, real_height, real_x, real_y);
 
-				cur_object = tds_object_create(type_ptr, ptr->object_buffer, ptr->sc_handle, real_x, real_y, 0.0f, cur_object_param);
+				struct tds_object_param* object_params = NULL;
+
+				if (cur_object_param_count) {
+					object_params = tds_malloc(sizeof *object_params * cur_object_param_count);
+					memcpy(object_params, cur_object_param, sizeof *object_params * cur_object_param_count);
+				}
+
+				cur_object = tds_object_create(type_ptr, ptr->object_buffer, ptr->kinematics_handle, ptr->sc_handle, real_x, real_y, 0.0f, object_params, cur_object_param_count);
 
-				cur_object->cbox_width = real_width;
-				cur_object->cbox_height = real_height;
+				tds_object_set_cbox(cur_object, real_width, real_height);
 
 				cur_object->visible = strcmp(obj_visible_buf, "0") ? 1 : 0;
 				cur_object->angle = strtof(obj_angle_buf, NULL) * 3.141f / 180.0f;
@@ -766,14 +1089,16 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 				memset(obj_width_buf, 0, sizeof obj_width_buf / sizeof *obj_width_buf);
 				memset(obj_height_buf, 0, sizeof obj_height_buf / sizeof *obj_height_buf);
 
-				cur_object_param = NULL;
+				cur_object_param_count = 0;
 			} else if (in_parameter) {
 				in_parameter = 0;
 
-				struct tds_object_param* next_param = tds_malloc(sizeof *next_param);
+				if (cur_object_param_count >= cur_object_param_capacity) {
+					cur_object_param_capacity = cur_object_param_capacity ? cur_object_param_capacity * 2 : 8;
+					cur_object_param = tds_realloc(cur_object_param, sizeof *cur_object_param * cur_object_param_capacity);
+				}
 
-				next_param->next = cur_object_param;
-				cur_object_param = next_param;
+				struct tds_object_param* next_param = cur_object_param + cur_object_param_count++;
 
 				switch (prop_name_buf[0]) {
 				default:
@@ -791,15 +1116,8 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 					next_param->fpart = strtof(prop_val_buf, NULL);
 					break;
 				case 's':
-					{
-						next_param->type = TDS_PARAM_STRING;
-						int srclen = strlen(prop_val_buf), writelen = srclen;
-						if (srclen > TDS_PARAM_VALSIZE) {
-							tds_logf(TDS_LOG_WARNING, "Parameter string longer than %d. Truncating..\n", TDS_PARAM_VALSIZE);
-							writelen = TDS_PARAM_VALSIZE;
-						}
-						memcpy(next_param->spart, prop_val_buf, writelen);
-					}
+					next_param->type = TDS_PARAM_STRING;
+					next_param->spart = tds_object_param_intern(prop_val_buf, strlen(prop_val_buf));
 					break;
 				}
 
@@ -843,6 +1161,10 @@ void tds_engine_load(struct tds_engine* ptr, const char* mapname) {
 		tds_free(id_buffer);
 	}
 
+	if (cur_object_param) {
+		tds_free(cur_object_param);
+	}
+
 	yxml_ret_t ret = yxml_eof(ctx);
 
 	if (ret < 0) {
@@ -863,31 +1185,32 @@ void tds_engine_request_load(struct tds_engine* ptr, const char* request_load) {
 }
 
 void tds_engine_destroy_objects(struct tds_engine* ptr, const char* type_name) {
-	for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
-		struct tds_object* cur = ptr->object_buffer->buffer[i].data;
+	struct tds_object_type* type = tds_object_type_cache_get(ptr->otc_handle, type_name);
 
-		if (!cur) {
-			continue;
-		}
+	if (!type) {
+		return;
+	}
 
-		if (!strcmp(cur->type_name, type_name)) {
-			tds_object_free(cur);
-		}
+	for (struct tds_object* cur = type->instance_head; cur; cur = cur->type_next) {
+		tds_engine_request_destroy(ptr, cur);
 	}
 }
 
 void tds_engine_broadcast(struct tds_engine* ptr, int msg, void* param) {
 	tds_module_container_broadcast(ptr->module_container_handle, msg, param);
 
-	for (int i = 0; i < ptr->object_buffer->max_index; ++i) {
-		struct tds_object* cur = ptr->object_buffer->buffer[i].data;
-
-		if (!cur) {
-			continue;
-		}
+	/* Only the instances of subscribed types are visited, through the per-type instance lists. */
+	struct tds_object_type_cache_subscription* sub = tds_object_type_cache_get_subscribers(ptr->otc_handle, msg);
 
-		tds_object_msg(cur, NULL, msg, param);
+	if (sub) {
+		_tds_engine_broadcast_types(ptr, sub, msg, param);
 	}
+
+	_tds_engine_broadcast_types(ptr, &ptr->otc_handle->all_msgs, msg, param);
+}
+
+void tds_engine_post_broadcast(struct tds_engine* ptr, int msg, void* param) {
+	tds_engine_post_msg(ptr, NULL, TDS_ENGINE_BROADCAST, msg, param);
 }
 
 struct tds_world* tds_engine_get_foreground_world(struct tds_engine* ptr) {
@@ -898,3 +1221,68 @@ struct tds_world* tds_engine_get_foreground_world(struct tds_engine* ptr) {
 
 	return ptr->world_buffer[ptr->world_buffer_count - 1];
 }
+
+static void _tds_engine_parallel_update(void* data, int start, int end) {
+	struct tds_object** list = data;
+
+	for (int i = start; i < end; ++i) {
+		list[i]->func_update(list[i]);
+	}
+}
+
+static void _tds_engine_broadcast_types(struct tds_engine* ptr, struct tds_object_type_cache_subscription* sub, int msg, void* param) {
+	/* Handlers may free any object, including the next one in an instance list, so the recipients are snapshotted as handles first
+	 * and each one is resolved again right before delivery. Freed objects no longer resolve and are skipped. */
+	int base = ptr->broadcast_size;
+
+	for (int i = 0; i < sub->count; ++i) {
+		for (struct tds_object* cur = sub->types[i]->instance_head; cur; cur = cur->type_next) {
+			if (ptr->broadcast_size >= ptr->broadcast_capacity) {
+				ptr->broadcast_capacity = ptr->broadcast_capacity ? ptr->broadcast_capacity * 2 : TDS_ENGINE_QUEUE_INITIAL_SIZE;
+				ptr->broadcast_handles = tds_realloc(ptr->broadcast_handles, sizeof *ptr->broadcast_handles * ptr->broadcast_capacity);
+			}
+
+			ptr->broadcast_handles[ptr->broadcast_size++] = cur->object_handle;
+		}
+	}
+
+	int end = ptr->broadcast_size;
+
+	for (int i = base; i < end; ++i) {
+		/* Index the buffer every time, a nested broadcast may have grown it. */
+		struct tds_object* cur = tds_handle_manager_get(ptr->object_buffer, ptr->broadcast_handles[i]);
+
+		if (!cur || cur->destroy_pending) {
+			continue;
+		}
+
+		tds_object_msg(cur, NULL, msg, param);
+	}
+
+	ptr->broadcast_size = base;
+}
+
+static void _tds_engine_anim_update(struct tds_engine* ptr) {
+	/* One pass per tick against the simulation clock, so frame changes do not depend on draw timing.
+	 * Only objects with a sprite are in anim_list, so objects that can never animate are not visited at all. */
+	double time_ms = ptr->state.time_ms;
+
+	for (int i = 0; i < ptr->anim_list.size; ++i) {
+		struct tds_object* target = ptr->anim_list.buffer[i];
+
+		if (!target->anim_running || target->spawn_pending || target->destroy_pending) {
+			continue;
+		}
+
+		tds_object_anim_update(target, time_ms);
+	}
+}
+
+static void _tds_engine_queue_push(struct tds_engine_object_queue* queue, struct tds_object* obj) {
+	if (queue->size >= queue->capacity) {
+		queue->capacity = queue->capacity ? queue->capacity * 2 : TDS_ENGINE_QUEUE_INITIAL_SIZE;
+		queue->buffer = tds_realloc(queue->buffer, sizeof *queue->buffer * queue->capacity);
+	}
+
+	queue->buffer[queue->size++] = obj;
+}
@@ -27,6 +27,8 @@
 #include "font_cache.h"
 #include "stringdb.h"
 #include "module.h"
+#include "worker.h"
+#include "replay.h"
 
 #define TDS_MAP_PREFIX "res/maps/"
 
@@ -64,6 +66,9 @@ struct tds_engine_desc {
 	struct tds_key_map_template* game_input;
 	int game_input_size;
 	unsigned int save_index;
+	int headless; /* Run without a window, renderer or audio device. Also enabled by the "headless" config variable. */
+	const char* replay_record_filename; /* Record per-tick input to this file. Also set by the "replay_record" config variable. */
+	const char* replay_play_filename; /* Drive the engine from a recorded input file, takes precedence over recording. Also set by "replay_play". */
 
 	void (*func_load_modules)(struct tds_module_container* container_handle);
 	void (*func_load_sounds)(struct tds_sound_cache* sndc_handle);
@@ -74,6 +79,10 @@ struct tds_engine_desc {
 };
 
 struct tds_engine_state {
+	double time_ms; /* Simulation time, advanced by exactly one timestep per update tick. Animations run on this clock. */
+	unsigned long tick_count;
+	float alpha; /* Fraction of a timestep between the last tick and this frame, for blending the previous and current state. */
+	unsigned long dropped_steps; /* Update ticks skipped because a frame needed more than max_steps. */
 	float fps;
 	int entity_maxindex;
 	char* mapname;
@@ -84,6 +93,24 @@ struct tds_engine_object_list {
 	int size;
 };
 
+struct tds_engine_object_queue {
+	struct tds_object** buffer;
+	int size, capacity;
+};
+
+#define TDS_ENGINE_BROADCAST 0 /* Queued message target meaning every subscriber. 0 is never a valid handle. */
+
+struct tds_engine_msg {
+	struct tds_object* sender;
+	int target, msg;
+	void* param;
+};
+
+struct tds_engine_msg_queue {
+	struct tds_engine_msg* buffer;
+	int size, capacity;
+};
+
 struct tds_engine {
 	struct tds_engine_desc desc;
 	struct tds_engine_state state;
@@ -98,6 +125,9 @@ struct tds_engine {
 	struct tds_sound_cache* sndc_handle;
 	struct tds_object_type_cache* otc_handle;
 	struct tds_handle_manager* object_buffer;
+	struct tds_kinematics* kinematics_handle;
+	struct tds_registry* param_strings; /* Interned string parameter values, shared by every object. */
+	pthread_mutex_t param_strings_lock; /* Parallel updates may set string params, interning happens under this lock. */
 	struct tds_input* input_handle;
 	struct tds_input_map* input_map_handle;
 	struct tds_key_map* key_map_handle;
@@ -113,12 +143,33 @@ struct tds_engine {
 	struct tds_stringdb* stringdb_handle;
 	struct tds_module_container* module_container_handle;
 	struct tds_part_manager* part_manager_handle;
+	struct tds_worker_pool* worker_pool_handle;
+	struct tds_replay* replay_handle; /* NULL unless recording or playing back input. */
 
 	int world_buffer_count;
 	struct tds_world* world_buffer[4];
+	int world_merge_rects; /* Build world layers with rectangle-merged hblocks, see tds_world_set_merge_rects. */
 
 	int run_flag;
 	struct tds_object** object_list;
+	int object_list_capacity;
+
+	struct tds_engine_object_queue spawn_queue, destroy_queue; /* Lifetime changes requested during a tick, applied between ticks. */
+	struct tds_engine_object_queue parallel_list; /* Objects with parallel-safe updates, rebuilt every tick. */
+	int* broadcast_handles; /* Recipient handles snapshotted by each broadcast, used as a stack so handlers can broadcast again. */
+	int broadcast_size, broadcast_capacity;
+	struct tds_engine_object_queue anim_list; /* Objects with a sprite, unordered. The animation pass walks this instead of the handle buffer. */
+	struct tds_engine_msg_queue msg_queue;
+	pthread_mutex_t queue_lock; /* Guards the destroy and message queues while the parallel phase is running. */
+	int parallel_phase;
+	int max_steps; /* Update ticks allowed per frame before the remaining time is dropped. */
+	int fps_cap, fps_cap_unfocused; /* Frame rate limits while focused and while unfocused or minimized, 0 for none. */
+	unsigned long tick_limit; /* Stop the mainloop after this many update ticks, 0 for no limit. Meant for soak tests and benchmarks. */
+
+	/* Headless engines run exactly one tick per loop iteration, skip drawing and never wait for the wall clock.
+	 * fps_cap then sets a fixed tick rate, or leave it at 0 to simulate as fast as possible. */
+	int headless;
+	unsigned int seed; /* Passed to srand() at startup, stored in recordings so playback sees the same random sequence. */
 
 	int enable_update, enable_draw, enable_fps;
 	char* request_load;
@@ -132,15 +183,26 @@ void tds_engine_flush_objects(struct tds_engine* ptr); /* destroys all objects i
 void tds_engine_terminate(struct tds_engine* ptr); /* flags the engine to stop soon */
 
 struct tds_object* tds_engine_get_object_by_type(struct tds_engine* ptr, const char* type);
-struct tds_engine_object_list tds_engine_get_object_list_by_type(struct tds_engine* ptr, const char* type); /* Allocates a buffer. Freed by the engine on shutdown. */
+struct tds_engine_object_list tds_engine_get_object_list_by_type(struct tds_engine* ptr, const char* type); /* Fills a buffer owned by the engine, valid until the next call. */
+struct tds_engine_object_list tds_engine_get_object_list_by_type_id(struct tds_engine* ptr, int type_id); /* Same as above, with an id from tds_object_type_cache_add or _find. */
 void tds_engine_object_foreach(struct tds_engine* ptr, void* data, void (*callback)(void* data, struct tds_object* obj));
 
 void tds_engine_load(struct tds_engine* ptr, const char* mapname);
 void tds_engine_request_load(struct tds_engine* ptr, const char* mapname); /* This doesn't immediately load the world but waits for the frame to finish. */
 void tds_engine_save(struct tds_engine* ptr, const char* mapname);
 
-void tds_engine_destroy_objects(struct tds_engine* ptr, const char* type_name);
-void tds_engine_broadcast(struct tds_engine* ptr, int msg, void* param);
+struct tds_object* tds_engine_spawn(struct tds_engine* ptr, struct tds_object_type* type, float x, float y, float z, struct tds_object_param* param_list, int param_count); /* Creates the object now, but it joins the update and draw loops after the current tick. */
+void tds_engine_request_destroy(struct tds_engine* ptr, struct tds_object* obj); /* Frees the object after the current tick. Safe to call from the object's own update. */
+void tds_engine_anim_track(struct tds_engine* ptr, struct tds_object* obj); /* Adds obj to anim_list, called when it gets a sprite. */
+void tds_engine_anim_untrack(struct tds_engine* ptr, struct tds_object* obj);
+void tds_engine_apply_queues(struct tds_engine* ptr); /* Delivers posted messages and applies pending spawns and destroys. The mainloop calls this between ticks. */
+
+void tds_engine_post_msg(struct tds_engine* ptr, struct tds_object* sender, int target, int msg, void* param); /* Queues a message for the target handle, delivered after the current phase. */
+void tds_engine_deliver_msgs(struct tds_engine* ptr);
+
+void tds_engine_destroy_objects(struct tds_engine* ptr, const char* type_name); /* Queues every object of the type for destruction. */
+void tds_engine_broadcast(struct tds_engine* ptr, int msg, void* param); /* Delivers now to modules and to objects whose type subscribes to [msg]. */
+void tds_engine_post_broadcast(struct tds_engine* ptr, int msg, void* param); /* Queued like tds_engine_post_msg, delivered with the next batch. */
 
 struct tds_world* tds_engine_get_foreground_world(struct tds_engine* ptr);
 
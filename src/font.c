@@ -1,6 +1,9 @@
 #include "font.h"
 #include "memory.h"
 #include "log.h"
+#include "headless.h"
+
+#include <string.h>
 
 #include <GLXW/glxw.h>
 
@@ -22,6 +25,11 @@ struct tds_font* tds_font_create(struct tds_ft* ft, const char* filename, int si
 	output->size_px = size;
 	FT_Set_Pixel_Sizes(output->face, 0, size);
 
+	if (tds_headless) {
+		memset(output->glyph_textures, 0, sizeof output->glyph_textures);
+		return output;
+	}
+
 	glGenTextures(sizeof output->glyph_textures / sizeof *(output->glyph_textures), output->glyph_textures);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
@@ -48,7 +56,9 @@ void tds_font_free(struct tds_font* ptr) {
 		return;
 	}
 
-	glDeleteTextures(sizeof ptr->glyph_textures / sizeof *(ptr->glyph_textures), ptr->glyph_textures);
+	if (!tds_headless) {
+		glDeleteTextures(sizeof ptr->glyph_textures / sizeof *(ptr->glyph_textures), ptr->glyph_textures);
+	}
 
 	FT_Done_Face(ptr->face);
 	tds_free(ptr);
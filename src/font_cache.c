@@ -8,55 +8,50 @@
 struct tds_font_cache* tds_font_cache_create(void) {
 	struct tds_font_cache* output = tds_malloc(sizeof(struct tds_font_cache));
 
-	output->head = output->tail = NULL;
+	output->registry = tds_registry_create();
 
 	return output;
 }
 
 void tds_font_cache_free(struct tds_font_cache* ptr) {
-	struct tds_font_cache_link* current = ptr->head, *tmp = NULL;
-
-	while (current) {
-		tmp = current;
-		tds_font_free(current->data);
-		current = current->next;
-		tds_free(tmp);
+	for (int i = 0; i < ptr->registry->count; ++i) {
+		tds_font_free(tds_registry_get(ptr->registry, i));
 	}
 
+	tds_registry_free(ptr->registry);
 	tds_free(ptr);
 }
 
 void tds_font_cache_add(struct tds_font_cache* ptr, const char* font_name, struct tds_font* font) {
-	struct tds_font_cache_link* current = NULL;
-	current = tds_malloc(sizeof(struct tds_font_cache_link));
-
-	current->prev = ptr->tail;
-	current->next = NULL;
-	current->name = font_name;
-	current->data = font;
-
-	if (!ptr->head) {
-		ptr->head = current;
-	}
+	int font_id = tds_registry_find(ptr->registry, font_name);
 
-	if (ptr->tail) {
-		ptr->tail->next = current;
+	if (font_id != TDS_REGISTRY_NONE && tds_registry_get(ptr->registry, font_id) != font) {
+		tds_logf(TDS_LOG_WARNING, "[%s] is already in the font cache, replacing it\n", font_name);
+		tds_font_free(tds_registry_get(ptr->registry, font_id));
 	}
 
-	ptr->tail = current;
+	tds_registry_add(ptr->registry, font_name, font);
 }
 
 struct tds_font* tds_font_cache_get(struct tds_font_cache* ptr, const char* font_name) {
-	struct tds_font_cache_link* current = ptr->head;
-
-	while (current) {
-		if (!strcmp(current->name, font_name)) {
-			return current->data;
-		}
+	int font_id = tds_registry_find(ptr->registry, font_name);
 
-		current = current->next;
+	if (font_id == TDS_REGISTRY_NONE) {
+		tds_logf(TDS_LOG_WARNING, "[%s] not found in font cache\n", font_name);
+		return NULL;
 	}
 
-	tds_logf(TDS_LOG_WARNING, "[%s] not found in font cache\n", font_name);
-	return NULL;
+	return tds_registry_get(ptr->registry, font_id);
+}
+
+int tds_font_cache_find(struct tds_font_cache* ptr, const char* font_name) {
+	return tds_registry_find(ptr->registry, font_name);
+}
+
+int tds_font_cache_find_hashed(struct tds_font_cache* ptr, const char* font_name, unsigned int hash) {
+	return tds_registry_find_hashed(ptr->registry, font_name, hash);
+}
+
+struct tds_font* tds_font_cache_get_by_id(struct tds_font_cache* ptr, int font_id) {
+	return tds_registry_get(ptr->registry, font_id);
 }
@@ -1,20 +1,18 @@
 #pragma once
 
 #include "font.h"
-
-struct tds_font_cache_link {
-	struct tds_font* data;
-	struct tds_font_cache_link* next, *prev;
-
-	const char* name;
-};
+#include "registry.h"
 
 struct tds_font_cache {
-	struct tds_font_cache_link* head, *tail;
+	struct tds_registry* registry;
 };
 
 struct tds_font_cache* tds_font_cache_create(void);
 void tds_font_cache_free(struct tds_font_cache* ptr);
 
 void tds_font_cache_add(struct tds_font_cache* ptr, const char* font_name, struct tds_font* obj);
-struct tds_font* tds_font_cache_get(struct tds_font_cache* ptr, const char* font_name);
+struct tds_font* tds_font_cache_get(struct tds_font_cache* ptr, const char* font_name); /* Returns NULL on a miss. */
+
+int tds_font_cache_find(struct tds_font_cache* ptr, const char* font_name); /* Returns the font id or TDS_REGISTRY_NONE. */
+int tds_font_cache_find_hashed(struct tds_font_cache* ptr, const char* font_name, unsigned int hash); /* hash from tds_registry_hash. */
+struct tds_font* tds_font_cache_get_by_id(struct tds_font_cache* ptr, int font_id);
@@ -4,20 +4,29 @@
 
 #include <string.h>
 
+static struct tds_handle_manager_entry* _tds_handle_manager_lookup(struct tds_handle_manager* ptr, handle id);
+static void _tds_handle_manager_resize(struct tds_handle_manager* ptr, unsigned int buffer_size);
+
 struct tds_handle_manager* tds_handle_manager_create(unsigned int buffer_size) {
 	struct tds_handle_manager* output = tds_malloc(sizeof(struct tds_handle_manager));
 	memset(output, 0, sizeof(struct tds_handle_manager));
 
-	output->buffer_size = buffer_size;
-	output->buffer = tds_malloc(sizeof(struct tds_handle_manager_entry) * buffer_size);
-	output->current_handle = 1;
-	output->max_index = 0;
+	if (buffer_size > TDS_HANDLE_INDEX_MASK + 1) {
+		tds_logf(TDS_LOG_WARNING, "Handle buffer size %d exceeds the handle index range, clamping to %d\n", buffer_size, TDS_HANDLE_INDEX_MASK + 1);
+		buffer_size = TDS_HANDLE_INDEX_MASK + 1;
+	}
 
-	for (int i = 0; i < output->buffer_size; ++i) {
-		output->buffer[i].index = 0;
-		output->buffer[i].data = NULL;
+	if (!buffer_size) {
+		buffer_size = 1;
 	}
 
+	output->buffer_size = 0;
+	output->buffer = NULL;
+	output->max_index = 0;
+	output->free_head = TDS_HANDLE_NONE;
+
+	_tds_handle_manager_resize(output, buffer_size);
+
 	return output;
 }
 
@@ -29,60 +38,99 @@ void tds_handle_manager_free(struct tds_handle_manager* ptr) {
 }
 
 void* tds_handle_manager_get(struct tds_handle_manager* ptr, handle id) {
-	for (int i = 0; i < ptr->max_index; ++i) {
-		if (ptr->buffer[i].index == id) {
-			return ptr->buffer[i].data;
-		}
+	struct tds_handle_manager_entry* entry = _tds_handle_manager_lookup(ptr, id);
+
+	if (!entry) {
+		/* Not an error : looking up a stale handle is how callers check whether an object is still alive. */
+		return NULL;
 	}
 
-	tds_logf(TDS_LOG_CRITICAL, "Handle not found in buffers");
-	return NULL;
+	return entry->data;
 }
 
 void tds_handle_manager_set(struct tds_handle_manager* ptr, handle id, void* data) {
-	for (int i = 0; i < ptr->max_index; ++i) {
-		if (ptr->buffer[i].index == id) {
-			ptr->buffer[i].data = data;
-			return;
-		}
+	struct tds_handle_manager_entry* entry = _tds_handle_manager_lookup(ptr, id);
+
+	if (!entry) {
+		tds_logf(TDS_LOG_DEBUG, "Ignoring set on stale or invalid handle %lu\n", id);
+		return;
 	}
 
-	tds_logf(TDS_LOG_CRITICAL, "Handle not found in buffers");
-}
+	if (data) {
+		entry->data = data;
+		return;
+	}
 
-handle tds_handle_manager_get_new(struct tds_handle_manager* ptr, void* data) {
-	if (ptr->max_index >= ptr->buffer_size) {
-		/* Resort the buffers here. */
-		/* The resort operation will be a linear slide iteration over the buffer, quickly filling the lower slots. We will NOT null out the last bits of the list. */
+	/* Releasing the slot : bump the generation so any outstanding copies of this handle stop resolving. */
+	entry->data = NULL;
+	entry->generation = (entry->generation + 1) & TDS_HANDLE_GENERATION_MASK;
+
+	if (!entry->generation) {
+		entry->generation = 1;
+	}
 
-		int new_index = 0;
-		for (int i = 0; i < ptr->buffer_size; ++i) {
-			if (ptr->buffer[i].data) {
-				handle tmpi = ptr->buffer[i].index;
-				void* tmpd = ptr->buffer[i].data;
+	entry->next_free = ptr->free_head;
+	ptr->free_head = id & TDS_HANDLE_INDEX_MASK;
+}
 
-				ptr->buffer[i].index = 0;
-				ptr->buffer[i].data = NULL;
+handle tds_handle_manager_get_new(struct tds_handle_manager* ptr, void* data) {
+	unsigned int index = 0;
+
+	if (ptr->free_head != TDS_HANDLE_NONE) {
+		index = ptr->free_head;
+		ptr->free_head = ptr->buffer[index].next_free;
+		ptr->buffer[index].next_free = TDS_HANDLE_NONE;
+	} else {
+		if (ptr->max_index >= ptr->buffer_size) {
+			/* Grow geometrically. Handles are slot indices, so moving the entry buffer never invalidates them. */
+			unsigned int new_size = ptr->buffer_size * 2;
+
+			if (new_size > TDS_HANDLE_INDEX_MASK + 1) {
+				new_size = TDS_HANDLE_INDEX_MASK + 1;
+			}
 
-				ptr->buffer[new_index].index = tmpi;
-				ptr->buffer[new_index++].data = tmpd;
+			if (new_size <= ptr->buffer_size) {
+				tds_logf(TDS_LOG_CRITICAL, "Buffer is full! (%d slots, handle index range exhausted)\n", ptr->buffer_size);
+				return 0;
 			}
+
+			tds_logf(TDS_LOG_DEBUG, "Growing handle buffer from %d to %d slots.\n", ptr->buffer_size, new_size);
+			_tds_handle_manager_resize(ptr, new_size);
 		}
 
-		tds_logf(TDS_LOG_DEBUG, "Performed resort operation, reduced fragmentation from %d slots usage to %d (buffer size %d)..\n", ptr->max_index, new_index, ptr->buffer_size);
+		index = ptr->max_index++;
+	}
+
+	ptr->buffer[index].data = data;
 
-		ptr->max_index = new_index;
+	return ((handle) ptr->buffer[index].generation << TDS_HANDLE_INDEX_BITS) | index;
+}
+
+static struct tds_handle_manager_entry* _tds_handle_manager_lookup(struct tds_handle_manager* ptr, handle id) {
+	unsigned int index = id & TDS_HANDLE_INDEX_MASK;
+	unsigned int generation = (id >> TDS_HANDLE_INDEX_BITS) & TDS_HANDLE_GENERATION_MASK;
+
+	if (index >= ptr->max_index) {
+		return NULL;
 	}
 
-	if (ptr->max_index >= ptr->buffer_size) {
-		/* Buffer is full. */
+	struct tds_handle_manager_entry* entry = ptr->buffer + index;
 
-		tds_logf(TDS_LOG_CRITICAL, "Buffer is full! (%d slots, post-resort)\n", ptr->buffer_size);
-		return 0;
+	if (entry->generation != generation || !entry->data) {
+		return NULL;
 	}
 
-	ptr->buffer[ptr->max_index].index = ptr->current_handle;
-	ptr->buffer[ptr->max_index++].data = data;
+	return entry;
+}
+
+static void _tds_handle_manager_resize(struct tds_handle_manager* ptr, unsigned int buffer_size) {
+	ptr->buffer = tds_realloc(ptr->buffer, sizeof(struct tds_handle_manager_entry) * buffer_size);
+
+	for (unsigned int i = ptr->buffer_size; i < buffer_size; ++i) {
+		ptr->buffer[i].data = NULL;
+		ptr->buffer[i].generation = 1;
+		ptr->buffer[i].next_free = TDS_HANDLE_NONE;
+	}
 
-	return ptr->current_handle++;
+	ptr->buffer_size = buffer_size;
 }
@@ -2,23 +2,33 @@
 
 /* The handle system is a simple indirection for managing pointers of dynamic world objects. */
 
+/* Handles are packed as (generation << TDS_HANDLE_INDEX_BITS) | slot. Lookups are a direct index into the buffer,
+ * and the generation is bumped every time a slot is released so stale handles never resolve to a recycled slot.
+ * Handles always fit in a positive int, and 0 is never a valid handle.
+ * The buffer starts at the requested size and doubles when every slot is in use; live handles stay valid across growth. */
+
+#define TDS_HANDLE_INDEX_BITS 20
+#define TDS_HANDLE_INDEX_MASK ((1UL << TDS_HANDLE_INDEX_BITS) - 1)
+#define TDS_HANDLE_GENERATION_MASK 0x7FFUL
+#define TDS_HANDLE_NONE ((unsigned int) -1)
+
 typedef unsigned long handle;
 
 struct tds_handle_manager_entry {
-	handle index;
 	void* data;
+	unsigned int generation, next_free;
 };
 
 struct tds_handle_manager {
 	struct tds_handle_manager_entry* buffer;
-	unsigned int max_index, buffer_size;
-	handle current_handle;
+	unsigned int max_index, buffer_size; /* buffer_size is the current capacity, max_index is one past the highest slot ever used, iterate up to it and skip NULL data. */
+	unsigned int free_head;
 };
 
 struct tds_handle_manager* tds_handle_manager_create(unsigned int buffer_size);
 void tds_handle_manager_free(struct tds_handle_manager* ptr);
 
-void* tds_handle_manager_get(struct tds_handle_manager* ptr, handle id);
-void tds_handle_manager_set(struct tds_handle_manager* ptr, handle id, void* data);
+void* tds_handle_manager_get(struct tds_handle_manager* ptr, handle id); /* Returns NULL, quietly, for stale or invalid handles. */
+void tds_handle_manager_set(struct tds_handle_manager* ptr, handle id, void* data); /* Setting NULL releases the slot and invalidates the handle. */
 
 handle tds_handle_manager_get_new(struct tds_handle_manager* ptr, void* data);
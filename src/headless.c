@@ -0,0 +1,3 @@
+#include "headless.h"
+
+int tds_headless = 0;
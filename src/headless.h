@@ -0,0 +1,8 @@
+#pragma once
+
+/* Headless mode runs the engine without a window, GL context or audio device.
+ * Modules which own GL or AL resources check tds_headless and become inert : creation skips the driver calls,
+ * drawing and playback return immediately. Everything CPU-side (sprites, worlds, objects, modules) still runs.
+ * The engine sets this from its description or config before any subsystem is created. */
+
+extern int tds_headless;
@@ -4,9 +4,12 @@
 #include "console.h"
 #include "engine.h"
 #include "msg.h"
+#include "replay.h"
 
 #include <string.h>
 
+static void _tds_input_event(int msg, int code);
+
 void _tds_input_char_callback(GLFWwindow* window, unsigned int inp) {
 	tds_console_char_pressed(tds_engine_global->console_handle, inp);
 }
@@ -14,6 +17,10 @@ void _tds_input_char_callback(GLFWwindow* window, unsigned int inp) {
 void _tds_input_mouse_callback(GLFWwindow* window, double mx, double my) {
 	struct tds_input* ptr = (struct tds_input*) glfwGetWindowUserPointer(window);
 
+	if (tds_engine_global->replay_handle && tds_engine_global->replay_handle->mode == TDS_REPLAY_PLAY) {
+		return; /* The replay owns the cursor. */
+	}
+
 	ptr->mx_last = ptr->mx;
 	ptr->my_last = ptr->my;
 
@@ -22,7 +29,7 @@ void _tds_input_mouse_callback(GLFWwindow* window, double mx, double my) {
 }
 
 void _tds_input_mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
-	tds_engine_broadcast(tds_engine_global, (action == GLFW_PRESS) ? TDS_MSG_MOUSE_PRESSED : TDS_MSG_MOUSE_RELEASED, &button);
+	_tds_input_event((action == GLFW_PRESS) ? TDS_MSG_MOUSE_PRESSED : TDS_MSG_MOUSE_RELEASED, button);
 }
 
 void _tds_input_scroll_callback(GLFWwindow* window, double sx, double sy) {
@@ -37,7 +44,7 @@ void _tds_input_key_callback(GLFWwindow* window, int key, int scancode, int acti
 		return;
 	}
 
-	tds_engine_broadcast(tds_engine_global, (action == GLFW_PRESS) ? TDS_MSG_KEY_PRESSED : TDS_MSG_KEY_RELEASED, &key);
+	_tds_input_event((action == GLFW_PRESS) ? TDS_MSG_KEY_PRESSED : TDS_MSG_KEY_RELEASED, key);
 }
 
 struct tds_input* tds_input_create(struct tds_display* display_handle) {
@@ -48,6 +55,10 @@ struct tds_input* tds_input_create(struct tds_display* display_handle) {
 
 	output->window_handle = display_handle->win_handle;
 
+	if (!output->window_handle) {
+		return output; /* Headless, there is nothing to poll. */
+	}
+
 	glfwSetWindowUserPointer(display_handle->win_handle, output);
 	glfwSetCharCallback(display_handle->win_handle, _tds_input_char_callback);
 	glfwSetMouseButtonCallback(display_handle->win_handle, _tds_input_mouse_button_callback);
@@ -63,6 +74,10 @@ void tds_input_free(struct tds_input* ptr) {
 }
 
 void tds_input_update(struct tds_input* ptr) {
+	if (!ptr->window_handle) {
+		return;
+	}
+
 	for (int i = 32; i < sizeof ptr->kb_state / sizeof *(ptr->kb_state); ++i) {
 		ptr->kb_state[i] = glfwGetKey(ptr->window_handle, i);
 	}
@@ -71,7 +86,9 @@ void tds_input_update(struct tds_input* ptr) {
 		ptr->mb_state[i] = glfwGetMouseButton(ptr->window_handle, i);
 	}
 
-	if (!tds_input_get_controller(ptr)) {
+	ptr->controller_present = glfwJoystickPresent(GLFW_JOYSTICK_1);
+
+	if (!ptr->controller_present) {
 		return;
 	}
 
@@ -99,12 +116,26 @@ void tds_input_update(struct tds_input* ptr) {
 }
 
 int tds_input_get_controller(struct tds_input* ptr) {
-	return glfwJoystickPresent(GLFW_JOYSTICK_1);
+	return ptr->controller_present;
 }
 
 void tds_input_set_mouse(struct tds_input* ptr, double mx, double my) {
-	glfwSetCursorPos(ptr->window_handle, mx, my);
+	if (ptr->window_handle) {
+		glfwSetCursorPos(ptr->window_handle, mx, my);
+	}
 
 	ptr->mx = mx;
 	ptr->my = my;
 }
+
+static void _tds_input_event(int msg, int code) {
+	struct tds_replay* replay = tds_engine_global->replay_handle;
+
+	if (replay) {
+		/* Recorded events are broadcast on the next tick; during playback live events are dropped. */
+		tds_replay_push_event(replay, msg, code);
+		return;
+	}
+
+	tds_engine_broadcast(tds_engine_global, msg, &code);
+}
@@ -10,6 +10,7 @@ struct tds_input {
 	int mb_state[5];
 	float controller_axis_state[32];
 	double mx, my, mx_last, my_last;
+	int controller_present; /* Sampled in tds_input_update. */
 };
 
 struct tds_input* tds_input_create(struct tds_display* display_handle);
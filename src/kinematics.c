@@ -0,0 +1,113 @@
+#include "kinematics.h"
+#include "memory.h"
+#include "log.h"
+
+#include <string.h>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+static void _tds_kinematics_resize_array(void** array, unsigned int elem_size, unsigned int old_count, unsigned int new_count);
+
+struct tds_kinematics* tds_kinematics_create(unsigned int capacity) {
+	struct tds_kinematics* output = tds_malloc(sizeof *output);
+	memset(output, 0, sizeof *output);
+
+	tds_kinematics_reserve(output, capacity ? capacity : 1);
+
+	return output;
+}
+
+void tds_kinematics_free(struct tds_kinematics* ptr) {
+	tds_free(ptr->x);
+	tds_free(ptr->y);
+	tds_free(ptr->xspeed);
+	tds_free(ptr->yspeed);
+	tds_free(ptr->prev_x);
+	tds_free(ptr->prev_y);
+	tds_free(ptr->cbox_width);
+	tds_free(ptr->cbox_height);
+	tds_free(ptr->layer);
+	tds_free(ptr);
+}
+
+void tds_kinematics_reserve(struct tds_kinematics* ptr, unsigned int count) {
+	if (count <= ptr->capacity) {
+		return;
+	}
+
+	unsigned int new_capacity = ptr->capacity * 2;
+
+	if (new_capacity < count) {
+		new_capacity = count;
+	}
+
+	tds_logf(TDS_LOG_DEBUG, "Growing kinematics store from %d to %d slots.\n", ptr->capacity, new_capacity);
+
+	_tds_kinematics_resize_array((void**) &ptr->x, sizeof *ptr->x, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->y, sizeof *ptr->y, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->xspeed, sizeof *ptr->xspeed, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->yspeed, sizeof *ptr->yspeed, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->prev_x, sizeof *ptr->prev_x, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->prev_y, sizeof *ptr->prev_y, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->cbox_width, sizeof *ptr->cbox_width, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->cbox_height, sizeof *ptr->cbox_height, ptr->capacity, new_capacity);
+	_tds_kinematics_resize_array((void**) &ptr->layer, sizeof *ptr->layer, ptr->capacity, new_capacity);
+
+	ptr->capacity = new_capacity;
+}
+
+void tds_kinematics_clear(struct tds_kinematics* ptr, unsigned int slot) {
+	/* Dead slots are still swept by the integration pass, zero velocity keeps them inert. */
+
+	ptr->x[slot] = ptr->y[slot] = 0.0f;
+	ptr->prev_x[slot] = ptr->prev_y[slot] = 0.0f;
+	ptr->xspeed[slot] = ptr->yspeed[slot] = 0.0f;
+	ptr->cbox_width[slot] = ptr->cbox_height[slot] = 0.0f;
+	ptr->layer[slot] = 0;
+}
+
+void tds_kinematics_snapshot(struct tds_kinematics* ptr, unsigned int count) {
+	if (count > ptr->capacity) {
+		count = ptr->capacity;
+	}
+
+	memcpy(ptr->prev_x, ptr->x, sizeof *ptr->x * count);
+	memcpy(ptr->prev_y, ptr->y, sizeof *ptr->y * count);
+}
+
+void tds_kinematics_integrate(struct tds_kinematics* ptr, unsigned int count) {
+	float* x = ptr->x, *y = ptr->y, *xspeed = ptr->xspeed, *yspeed = ptr->yspeed;
+	unsigned int i = 0;
+
+	if (count > ptr->capacity) {
+		count = ptr->capacity;
+	}
+
+#ifdef __AVX__
+	for (; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(xspeed + i)));
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(yspeed + i)));
+	}
+#endif
+
+#ifdef __SSE__
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(xspeed + i)));
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(yspeed + i)));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		x[i] += xspeed[i];
+		y[i] += yspeed[i];
+	}
+}
+
+static void _tds_kinematics_resize_array(void** array, unsigned int elem_size, unsigned int old_count, unsigned int new_count) {
+	*array = tds_realloc(*array, elem_size * new_count);
+	memset((char*) *array + elem_size * old_count, 0, elem_size * (new_count - old_count));
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/* The kinematics store keeps per-object simulation state in dense arrays indexed by handle slot.
+ * Position, velocity, collision box and layer live here instead of in struct tds_object, so the integration pass
+ * streams through a few tightly packed float arrays instead of touching every object.
+ * Object code should use the tds_object_get_* / tds_object_set_* accessors in object.h. */
+
+struct tds_kinematics {
+	float* x, *y, *xspeed, *yspeed;
+	float* prev_x, *prev_y; /* Positions at the start of the last tick, for render interpolation. */
+	float* cbox_width, *cbox_height;
+	int* layer;
+
+	unsigned int capacity;
+	float alpha; /* How far rendering is between prev_* and the current position, set by the engine every frame. */
+};
+
+struct tds_kinematics* tds_kinematics_create(unsigned int capacity);
+void tds_kinematics_free(struct tds_kinematics* ptr);
+
+void tds_kinematics_reserve(struct tds_kinematics* ptr, unsigned int count); /* Grows the arrays geometrically so at least [count] slots are valid. */
+void tds_kinematics_clear(struct tds_kinematics* ptr, unsigned int slot);
+
+void tds_kinematics_snapshot(struct tds_kinematics* ptr, unsigned int count); /* Copies positions into prev_* for slots [0, count). */
+void tds_kinematics_integrate(struct tds_kinematics* ptr, unsigned int count); /* Adds velocity to position for slots [0, count). */
@@ -7,7 +7,9 @@
 #define TDS_LOG_MESSAGE  2
 #define TDS_LOG_DEBUG  3
 
-#define TDS_LOG_LEVEL TDS_LOG_DEBUG
+#ifndef TDS_LOG_LEVEL
+#define TDS_LOG_LEVEL TDS_LOG_DEBUG /* Can be overridden by the build, the benchmark target builds with warnings only. */
+#endif
 
 void tds_vlog(int level, const char* fmt, va_list args);
 void tds_log(int level, const char* fmt, ...);
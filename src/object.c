@@ -1,14 +1,36 @@
 #include "object.h"
+#include "engine.h"
 #include "log.h"
 #include "memory.h"
 
 #include <stdlib.h>
 #include <string.h>
 
-struct tds_object* tds_object_create(struct tds_object_type* type, struct tds_handle_manager* hmgr, struct tds_sprite_cache* smgr, float x, float y, float z, struct tds_object_param* param_list) {
-	struct tds_object* output = tds_malloc(sizeof(struct tds_object));
+static int _tds_object_search_param(struct tds_object* ptr, unsigned int key);
+static struct tds_object_param* _tds_object_find_param(struct tds_object* ptr, unsigned int key, int type);
+static struct tds_object_param* _tds_object_insert_param(struct tds_object* ptr, unsigned int key);
+
+struct tds_object* tds_object_create(struct tds_object_type* type, struct tds_handle_manager* hmgr, struct tds_kinematics* kin, struct tds_sprite_cache* smgr, float x, float y, float z, struct tds_object_param* param_list, int param_count) {
+	if (!type->pool) {
+		type->pool = tds_pool_create(TDS_OBJECT_DATA_OFFSET + type->data_size, TDS_OBJECT_POOL_SLAB);
+	}
+
+	struct tds_object* output = tds_pool_alloc(type->pool);
 
 	output->type_name = type->type_name;
+	output->type = type;
+
+	output->type_prev = type->instance_tail;
+	output->type_next = NULL;
+
+	if (type->instance_tail) {
+		type->instance_tail->type_next = output;
+	} else {
+		type->instance_head = output;
+	}
+
+	type->instance_tail = output;
+	type->instance_count++;
 
 	tds_logf(TDS_LOG_MESSAGE, "Creating object of type [%s]\n", type->type_name);
 
@@ -18,38 +40,67 @@ struct tds_object* tds_object_create(struct tds_object_type* type, struct tds_ha
 	output->func_msg = type->func_msg;
 	output->func_destroy = type->func_destroy;
 
-	output->x = x;
-	output->y = y;
 	output->z = z;
 	output->save = type->save;
-	output->xspeed = output->yspeed = 0.0;
+	output->spawn_pending = output->destroy_pending = 0;
+	output->parallel_update = type->parallel_update;
 	output->snd_volume = 1.0f;
 	output->snd_loop = 0;
 	output->angle = 0.0f;
-	output->layer = 0; /* Layers are rendered with lower numbers on bottom, higher numbers on top. */
+	output->transform_valid = 0;
 
 	output->r = output->g = output->b = output->a = 1.0f;
 
-	output->sprite_handle = type->default_sprite ? tds_sprite_cache_get(smgr, type->default_sprite) : NULL;
+	output->sprite_handle = NULL;
+
+	if (type->default_sprite) {
+		if (!type->default_sprite_hash) {
+			type->default_sprite_hash = tds_registry_hash(type->default_sprite);
+		}
+
+		int sprite_id = tds_sprite_cache_find_hashed(smgr, type->default_sprite, type->default_sprite_hash);
+
+		if (sprite_id == TDS_REGISTRY_NONE) {
+			tds_logf(TDS_LOG_WARNING, "Default sprite [%s] for type [%s] not found in sprite cache\n", type->default_sprite, type->type_name);
+		} else {
+			output->sprite_handle = tds_sprite_cache_get_by_id(smgr, sprite_id);
+		}
+	}
 	output->visible = (output->sprite_handle != NULL);
 
-	output->object_data = type->data_size ? tds_malloc(type->data_size) : NULL;
+	output->object_data = type->data_size ? (char*) output + TDS_OBJECT_DATA_OFFSET : NULL;
 	output->object_handle = tds_handle_manager_get_new(hmgr, output);
 	output->hmgr = hmgr;
+
+	output->kin = kin;
+	output->slot = output->object_handle & TDS_HANDLE_INDEX_MASK;
+
+	tds_kinematics_reserve(kin, output->slot + 1);
+	tds_kinematics_clear(kin, output->slot);
+
+	tds_object_teleport(output, x, y);
+	tds_object_set_layer(output, 0); /* Layers are rendered with lower numbers on bottom, higher numbers on top. */
 	output->smgr = smgr;
 	output->current_frame = 0;
 
-	output->anim_lastframe = tds_clock_get_point();
+	output->anim_lastframe = tds_engine_global->state.time_ms;
 	output->anim_oneshot = 0;
 	output->anim_speed_offset = 0.0f;
 	output->anim_running = (output->sprite_handle != NULL);
+	output->anim_index = -1;
 
-	output->snd_src = tds_sound_source_create();
+	if (output->sprite_handle) {
+		tds_engine_anim_track(tds_engine_global, output);
+	}
+
+	output->snd_src = NULL; /* Borrowed from the sound manager only while a sound plays. */
 	output->param_list = param_list;
+	output->param_count = output->param_capacity = param_count;
+
+	tds_object_param_sort(output->param_list, &output->param_count);
 
 	if (output->sprite_handle) {
-		output->cbox_width = output->sprite_handle->width;
-		output->cbox_height = output->sprite_handle->height;
+		tds_object_set_cbox(output, output->sprite_handle->width, output->sprite_handle->height);
 	}
 
 	tds_logf(TDS_LOG_MESSAGE, "created object with handle %d, sprite %X\n", output->object_handle, (unsigned long) output->sprite_handle);
@@ -70,55 +121,84 @@ void tds_object_free(struct tds_object* ptr) {
 		tds_handle_manager_set(ptr->hmgr, ptr->object_handle, NULL);
 	}
 
-	if (ptr->object_data) {
-		tds_free(ptr->object_data);
+	tds_kinematics_clear(ptr->kin, ptr->slot);
+	tds_engine_anim_untrack(tds_engine_global, ptr);
+
+	if (ptr->type_prev) {
+		ptr->type_prev->type_next = ptr->type_next;
+	} else {
+		ptr->type->instance_head = ptr->type_next;
+	}
+
+	if (ptr->type_next) {
+		ptr->type_next->type_prev = ptr->type_prev;
+	} else {
+		ptr->type->instance_tail = ptr->type_prev;
 	}
 
-	struct tds_object_param* head = ptr->param_list, *tmp = NULL;
+	ptr->type->instance_count--;
+
+	if (ptr->param_list) {
+		tds_free(ptr->param_list);
+	}
 
-	while (head) {
-		tmp = head->next;
-		tds_free(head);
-		head = tmp;
+	if (ptr->snd_src) {
+		tds_sound_manager_release(tds_engine_global->sound_manager_handle, ptr->snd_src);
 	}
 
-	tds_sound_source_free(ptr->snd_src);
-	tds_free(ptr);
+	tds_pool_release(ptr->type->pool, ptr);
 }
 
 void tds_object_set_sprite(struct tds_object* ptr, struct tds_sprite* sprite) {
 	if (ptr->sprite_handle != sprite) {
 		ptr->sprite_handle = sprite;
 		ptr->current_frame = 0;
+
+		if (sprite) {
+			tds_engine_anim_track(tds_engine_global, ptr);
+		} else {
+			tds_engine_anim_untrack(tds_engine_global, ptr);
+		}
 	}
 }
 
 void tds_object_send_msg(struct tds_object* ptr, int handle, int msg, void* data) {
+	if (tds_engine_global && tds_engine_global->parallel_phase) {
+		/* Other objects may be mid-update on another thread, hold the message until the phase is over. */
+		tds_engine_post_msg(tds_engine_global, ptr, handle, msg, data);
+		return;
+	}
+
 	struct tds_object* target = tds_handle_manager_get(ptr->hmgr, handle);
 
-	target->func_msg(target, ptr, msg, data);
-}
+	if (!target) {
+		return;
+	}
 
-vec4* tds_object_get_transform(struct tds_object* ptr) {
-	mat4x4 id, pos, rot;
+	tds_object_msg(target, ptr, msg, data);
+}
 
-	mat4x4_identity(ptr->transform);
-	mat4x4_identity(id);
+struct tds_affine* tds_object_get_transform(struct tds_object* ptr) {
+	/* The rotation is only rebuilt when the angle changes. The translation is cheap, so it is refreshed from the kinematics store every call. */
 
-	mat4x4_translate(pos, ptr->x, ptr->y, ptr->z);
-	mat4x4_rotate_Z(rot, id, ptr->angle);
+	if (!ptr->transform_valid || ptr->transform_angle != ptr->angle) {
+		tds_affine_rotate_translate(&ptr->transform, ptr->angle, 0.0f, 0.0f);
+		ptr->transform_angle = ptr->angle;
+		ptr->transform_valid = 1;
+	}
 
-	mat4x4_mul(ptr->transform, pos, rot);
+	ptr->transform.tx = tds_object_get_render_x(ptr);
+	ptr->transform.ty = tds_object_get_render_y(ptr);
 
-	return ptr->transform;
-};
+	return &ptr->transform;
+}
 
-void tds_object_anim_update(struct tds_object* ptr) {
+void tds_object_anim_update(struct tds_object* ptr, double time_ms) {
 	if (!ptr->anim_running || !ptr->sprite_handle) {
 		return;
 	}
 
-	double current_time = tds_clock_get_ms(ptr->anim_lastframe);
+	double current_time = time_ms - ptr->anim_lastframe;
 	double interval = (double) ptr->sprite_handle->animation_rate + ptr->anim_speed_offset;
 
 	if (!interval) {
@@ -126,7 +206,12 @@ void tds_object_anim_update(struct tds_object* ptr) {
 	}
 
 	if (current_time >= interval) {
-		ptr->anim_lastframe = tds_clock_get_point();
+		/* Keep the overshoot, ticks rarely line up with the animation rate. After a stall, resync instead of flipping a frame every tick. */
+		ptr->anim_lastframe += interval;
+
+		if (time_ms - ptr->anim_lastframe >= interval) {
+			ptr->anim_lastframe = time_ms;
+		}
 
 		if (ptr->current_frame == ptr->sprite_handle->texture->frame_count - 1) {
 			if (ptr->anim_oneshot) {
@@ -143,7 +228,7 @@ void tds_object_anim_update(struct tds_object* ptr) {
 void tds_object_anim_start(struct tds_object* ptr) {
 	ptr->current_frame = 0;
 	ptr->anim_running = 1;
-	ptr->anim_lastframe = tds_clock_get_point();
+	ptr->anim_lastframe = tds_engine_global->state.time_ms;
 }
 
 void tds_object_anim_pause(struct tds_object* ptr) {
@@ -171,19 +256,16 @@ void tds_object_init(struct tds_object* ptr) {
 }
 
 void tds_object_update(struct tds_object* ptr) {
+	/* Speed is integrated into position by the engine's batched kinematics pass after every object has updated. */
+
 	if (ptr->func_update) {
 		ptr->func_update(ptr);
 	}
 
-	ptr->x += ptr->xspeed;
-	ptr->y += ptr->yspeed;
-
 	tds_object_update_sndsrc(ptr);
 }
 
 void tds_object_draw(struct tds_object* ptr) {
-	tds_object_anim_update(ptr);
-
 	if (ptr->func_draw) {
 		ptr->func_draw(ptr);
 	}
@@ -202,210 +284,194 @@ void tds_object_destroy(struct tds_object* ptr) {
 }
 
 void tds_object_update_sndsrc(struct tds_object* ptr) {
-	tds_sound_source_set_pos(ptr->snd_src, ptr->x, ptr->y);
-	tds_sound_source_set_vel(ptr->snd_src, ptr->xspeed, ptr->yspeed);
+	if (!ptr->snd_src) {
+		return;
+	}
+
+	tds_sound_source_set_pos(ptr->snd_src, tds_object_get_x(ptr), tds_object_get_y(ptr));
+	tds_sound_source_set_vel(ptr->snd_src, tds_object_get_xspeed(ptr), tds_object_get_yspeed(ptr));
 	tds_sound_source_set_vol(ptr->snd_src, ptr->snd_volume);
 	tds_sound_source_set_loop(ptr->snd_src, ptr->snd_loop);
 }
 
-int* tds_object_get_ipart(struct tds_object* ptr, unsigned int index) {
-	struct tds_object_param* head = ptr->param_list;
-
-	while (head) {
-		if (head->key == index) {
-			if (head->type == TDS_PARAM_INT) {
-				return &head->ipart;
-			} else {
-				tds_logf(TDS_LOG_WARNING, "Type mismatch in parameter.\n");
-				return NULL;
-			}
-		}
-
-		head = head->next;
+void tds_object_play_sound(struct tds_object* ptr, struct tds_sound_buffer* buf) {
+	if (!ptr->snd_src && !tds_sound_manager_acquire(tds_engine_global->sound_manager_handle, &ptr->snd_src)) {
+		return;
 	}
 
-	return NULL;
+	tds_sound_source_load_buffer(ptr->snd_src, buf);
+	tds_object_update_sndsrc(ptr);
+	tds_sound_source_play(ptr->snd_src);
 }
 
-char* tds_object_get_spart(struct tds_object* ptr, unsigned int index) {
-	struct tds_object_param* head = ptr->param_list;
-
-	while (head) {
-		if (head->key == index) {
-			if (head->type == TDS_PARAM_STRING) {
-				return head->spart;
-			} else {
-				tds_logf(TDS_LOG_WARNING, "Type mismatch in parameter.\n");
-				return NULL;
-			}
-		}
-
-		head = head->next;
+void tds_object_stop_sound(struct tds_object* ptr) {
+	if (ptr->snd_src) {
+		tds_sound_manager_release(tds_engine_global->sound_manager_handle, ptr->snd_src);
 	}
-
-	return NULL;
 }
 
-unsigned int* tds_object_get_upart(struct tds_object* ptr, unsigned int index) {
-	struct tds_object_param* head = ptr->param_list;
-
-	while (head) {
-		if (head->key == index) {
-			if (head->type == TDS_PARAM_UINT) {
-				return &head->upart;
-			} else {
-				tds_logf(TDS_LOG_WARNING, "Type mismatch in parameter.\n");
-				return NULL;
-			}
-		}
+int* tds_object_get_ipart(struct tds_object* ptr, unsigned int index) {
+	struct tds_object_param* param = _tds_object_find_param(ptr, index, TDS_PARAM_INT);
+	return param ? &param->ipart : NULL;
+}
 
-		head = head->next;
-	}
+const char* tds_object_get_spart(struct tds_object* ptr, unsigned int index) {
+	struct tds_object_param* param = _tds_object_find_param(ptr, index, TDS_PARAM_STRING);
+	return param ? param->spart : NULL;
+}
 
-	return NULL;
+unsigned int* tds_object_get_upart(struct tds_object* ptr, unsigned int index) {
+	struct tds_object_param* param = _tds_object_find_param(ptr, index, TDS_PARAM_UINT);
+	return param ? &param->upart : NULL;
 }
 
 float* tds_object_get_fpart(struct tds_object* ptr, unsigned int index) {
-	struct tds_object_param* head = ptr->param_list;
-
-	while (head) {
-		if (head->key == index) {
-			if (head->type == TDS_PARAM_FLOAT) {
-				return &head->fpart;
-			} else {
-				tds_logf(TDS_LOG_WARNING, "Type mismatch in parameter.\n");
-				return NULL;
-			}
-		}
-
-		head = head->next;
-	}
-
-	return NULL;
+	struct tds_object_param* param = _tds_object_find_param(ptr, index, TDS_PARAM_FLOAT);
+	return param ? &param->fpart : NULL;
 }
 
 void tds_object_set_ipart(struct tds_object* ptr, unsigned int index, int value) {
-	struct tds_object_param* cur = ptr->param_list, *head = ptr->param_list, *new = NULL;
+	struct tds_object_param* param = _tds_object_insert_param(ptr, index);
 
-	while (cur) {
-		if (cur->key == index) {
-			cur->type = TDS_PARAM_INT;
-			cur->ipart = value;
-
-			return;
-		}
+	param->type = TDS_PARAM_INT;
+	param->ipart = value;
+}
 
-		cur = cur->next;
+void tds_object_set_spart(struct tds_object* ptr, unsigned int index, const char* value, int value_len) {
+	if (value_len < 0) {
+		tds_logf(TDS_LOG_WARNING, "Invalid parameter string length.\n");
+		return;
 	}
 
-	new = tds_malloc(sizeof *new);
+	const char* interned = tds_object_param_intern(value, value_len);
+	struct tds_object_param* param = _tds_object_insert_param(ptr, index);
 
-	new->key = index;
-	new->type = TDS_PARAM_INT;
-	new->ipart = value;
+	param->type = TDS_PARAM_STRING;
+	param->spart = interned;
+}
 
-	// Growing the list from the head decreases code size. A lot.
-	new->next = head;
-	ptr->param_list = new;
+void tds_object_set_upart(struct tds_object* ptr, unsigned int index, unsigned int value) {
+	struct tds_object_param* param = _tds_object_insert_param(ptr, index);
+
+	param->type = TDS_PARAM_UINT;
+	param->upart = value;
 }
 
-void tds_object_set_spart(struct tds_object* ptr, unsigned int index, char* value, int value_len) {
-	struct tds_object_param* cur = ptr->param_list, *head = ptr->param_list, *new = NULL;
+void tds_object_set_fpart(struct tds_object* ptr, unsigned int index, float value) {
+	struct tds_object_param* param = _tds_object_insert_param(ptr, index);
 
-	int copy_len = value_len > TDS_PARAM_VALSIZE ? TDS_PARAM_VALSIZE : value_len;
+	param->type = TDS_PARAM_FLOAT;
+	param->fpart = value;
+}
 
-	if (copy_len < 0) {
-		tds_logf(TDS_LOG_WARNING, "Invalid parameter string length.\n");
+void tds_object_unset(struct tds_object* ptr, unsigned int index) {
+	int pos = _tds_object_search_param(ptr, index);
+
+	if (pos >= ptr->param_count || ptr->param_list[pos].key != index) {
 		return;
 	}
 
-	while (cur) {
-		if (cur->key == index) {
-			cur->type = TDS_PARAM_INT;
-			memset(cur->spart, 0, TDS_PARAM_VALSIZE);
-			memcpy(cur->spart, value, copy_len);
+	memmove(ptr->param_list + pos, ptr->param_list + pos + 1, sizeof *ptr->param_list * (ptr->param_count - pos - 1));
+	ptr->param_count--;
+}
 
-			return;
-		}
+const char* tds_object_param_intern(const char* value, int value_len) {
+	char buf[TDS_PARAM_VALSIZE + 1] = {0};
 
-		cur = cur->next;
+	if (value_len > TDS_PARAM_VALSIZE) {
+		tds_logf(TDS_LOG_WARNING, "Parameter string longer than %d. Truncating..\n", TDS_PARAM_VALSIZE);
+		value_len = TDS_PARAM_VALSIZE;
 	}
 
-	new = tds_malloc(sizeof *new);
+	memcpy(buf, value, value_len);
+
+	/* Keys are allocated separately from the registry table, so the returned pointer survives later rehashes. */
+	struct tds_registry* pool = tds_engine_global->param_strings;
 
-	new->key = index;
-	new->type = TDS_PARAM_INT;
-	memset(new->spart, 0, TDS_PARAM_VALSIZE);
-	memcpy(new->spart, value, copy_len);
+	pthread_mutex_lock(&tds_engine_global->param_strings_lock);
+	const char* output = tds_registry_get_key(pool, tds_registry_add(pool, buf, NULL));
+	pthread_mutex_unlock(&tds_engine_global->param_strings_lock);
 
-	new->next = head;
-	ptr->param_list = new;
+	return output;
 }
 
-void tds_object_set_upart(struct tds_object* ptr, unsigned int index, unsigned int value) {
-	struct tds_object_param* cur = ptr->param_list, *head = ptr->param_list, *new = NULL;
+void tds_object_param_sort(struct tds_object_param* params, int* count) {
+	/* Insertion sort : parameter lists are short and usually close to sorted.
+	 * The sort is stable, so when a key repeats the later entry wins, like it would with repeated set calls. */
 
-	while (cur) {
-		if (cur->key == index) {
-			cur->type = TDS_PARAM_UINT;
-			cur->upart = value;
+	for (int i = 1; i < *count; ++i) {
+		struct tds_object_param tmp = params[i];
+		int j = i - 1;
 
-			return;
+		while (j >= 0 && params[j].key > tmp.key) {
+			params[j + 1] = params[j];
+			--j;
 		}
 
-		cur = cur->next;
+		params[j + 1] = tmp;
 	}
 
-	new = tds_malloc(sizeof *new);
+	int write = 0;
 
-	new->key = index;
-	new->type = TDS_PARAM_UINT;
-	new->upart = value;
+	for (int i = 0; i < *count; ++i) {
+		if (write && params[write - 1].key == params[i].key) {
+			params[write - 1] = params[i];
+		} else {
+			params[write++] = params[i];
+		}
+	}
 
-	new->next = head;
-	ptr->param_list = new;
+	*count = write;
 }
 
-void tds_object_set_fpart(struct tds_object* ptr, unsigned int index, float value) {
-	struct tds_object_param* cur = ptr->param_list, *head = ptr->param_list, *new = NULL;
+static int _tds_object_search_param(struct tds_object* ptr, unsigned int key) {
+	/* Returns the position of the key, or where it would be inserted. */
+	int low = 0, high = ptr->param_count;
 
-	while (cur) {
-		if (cur->key == index) {
-			cur->type = TDS_PARAM_FLOAT;
-			cur->fpart = value;
+	while (low < high) {
+		int mid = (low + high) / 2;
 
-			return;
+		if (ptr->param_list[mid].key < key) {
+			low = mid + 1;
+		} else {
+			high = mid;
 		}
-
-		cur = cur->next;
 	}
 
-	new = tds_malloc(sizeof *new);
+	return low;
+}
 
-	new->key = index;
-	new->type = TDS_PARAM_FLOAT;
-	new->fpart = value;
+static struct tds_object_param* _tds_object_find_param(struct tds_object* ptr, unsigned int key, int type) {
+	int pos = _tds_object_search_param(ptr, key);
 
-	new->next = head;
-	ptr->param_list = new;
-}
+	if (pos >= ptr->param_count || ptr->param_list[pos].key != key) {
+		return NULL;
+	}
 
-void tds_object_unset(struct tds_object* ptr, unsigned int index) {
-	struct tds_object_param* cur = ptr->param_list, *prev = NULL;
+	if (ptr->param_list[pos].type != type) {
+		tds_logf(TDS_LOG_WARNING, "Type mismatch in parameter.\n");
+		return NULL;
+	}
 
-	while (cur) {
-		if (cur->key == index) {
-			if (prev) {
-				prev->next = cur->next;
-			} else {
-				ptr->param_list = cur->next;
-			}
+	return ptr->param_list + pos;
+}
 
-			tds_free(cur);
-			return;
-		}
+static struct tds_object_param* _tds_object_insert_param(struct tds_object* ptr, unsigned int key) {
+	int pos = _tds_object_search_param(ptr, key);
+
+	if (pos < ptr->param_count && ptr->param_list[pos].key == key) {
+		return ptr->param_list + pos;
+	}
 
-		cur = cur->next;
-		prev = cur;
+	if (ptr->param_count >= ptr->param_capacity) {
+		ptr->param_capacity = ptr->param_capacity ? ptr->param_capacity * 2 : 4;
+		ptr->param_list = tds_realloc(ptr->param_list, sizeof *ptr->param_list * ptr->param_capacity);
 	}
+
+	memmove(ptr->param_list + pos + 1, ptr->param_list + pos, sizeof *ptr->param_list * (ptr->param_count - pos));
+	ptr->param_count++;
+
+	ptr->param_list[pos].key = key;
+
+	return ptr->param_list + pos;
 }
@@ -2,49 +2,67 @@
 
 #include "sprite.h"
 #include "handle.h"
+#include "kinematics.h"
 #include "linmath.h"
+#include "affine.h"
 #include "clock.h"
 #include "sprite_cache.h"
 #include "sound_source.h"
+#include "pool.h"
 
 struct tds_object_param;
+struct tds_object_type;
 
-#define TDS_PARAM_VALSIZE 128
+#define TDS_OBJECT_POOL_SLAB 64 /* Objects per pool slab. */
+#define TDS_OBJECT_DATA_OFFSET ((sizeof(struct tds_object) + TDS_POOL_ALIGN - 1) & ~(TDS_POOL_ALIGN - 1)) /* object_data sits inline right after the object. */
+
+#define TDS_OBJECT_NO_BROADCASTS ((const int[]) {0}) /* Empty subscription list, use with msg_subscription_count = 0. */
+
+#define TDS_PARAM_VALSIZE 128 /* Longest string parameter, longer strings are truncated. */
 
 #define TDS_PARAM_INT 0
 #define TDS_PARAM_STRING 1
 #define TDS_PARAM_FLOAT 2
 #define TDS_PARAM_UINT 3
 
+/* Parameters are stored in one array per object, sorted by key. Strings live out-of-line in the engine's interned string pool. */
+
 struct tds_object_param {
 	unsigned int key;
+	int type;
 
 	union {
-		char spart[TDS_PARAM_VALSIZE];
+		const char* spart;
 		int ipart;
 		unsigned int upart;
 		float fpart;
 	};
-
-	int type;
-
-	struct tds_object_param* next;
 }; // To do this right, no object code should EVER have to deal with this structure.
 
 struct tds_object {
 	struct tds_sprite* sprite_handle;
 	const char* type_name;
 
-	int visible, layer, save; /* Save : will the object be exported? If not, the editor will not create a selector for it and the engine will ignore it during saving. */
-	float x, y, z, angle, r, g, b, a, xspeed, yspeed;
-	float cbox_width, cbox_height;
+	struct tds_object_type* type;
+	struct tds_object* type_next, *type_prev; /* Intrusive list of live objects sharing this type, in creation order. */
+
+	int visible, save; /* Save : will the object be exported? If not, the editor will not create a selector for it and the engine will ignore it during saving. */
+	int spawn_pending, destroy_pending; /* Set while the object sits in one of the engine's lifetime queues. */
+	int parallel_update;
+	float z, angle, r, g, b, a;
 
-	tds_clock_point anim_lastframe;
+	struct tds_kinematics* kin; /* Position, speed, collision box and layer live in the kinematics store at [slot]. */
+	unsigned int slot;
+
+	double anim_lastframe; /* Engine simulation time of the last frame change, in ms. */
 	double anim_speed_offset;
 	int anim_oneshot, anim_running;
+	int anim_index; /* Position in the engine's anim_list while the object has a sprite, -1 otherwise. */
 	unsigned int current_frame;
 
-	mat4x4 transform;
+	struct tds_affine transform; /* Cached by tds_object_get_transform, the rotation is rebuilt when angle changes. */
+	float transform_angle;
+	int transform_valid;
 
 	void (*func_init)(struct tds_object* ptr);
 	void (*func_destroy)(struct tds_object* ptr);
@@ -57,12 +75,13 @@ struct tds_object {
 
 	struct tds_handle_manager* hmgr;
 	struct tds_sprite_cache* smgr;
-	struct tds_sound_source* snd_src;
+	struct tds_sound_source* snd_src; /* NULL unless the object is playing a sound, use tds_object_play_sound. */
 
 	float snd_volume;
 	int snd_loop;
 
 	struct tds_object_param* param_list;
+	int param_count, param_capacity;
 };
 
 struct tds_object_type {
@@ -71,21 +90,43 @@ struct tds_object_type {
 
 	int data_size, save;
 
+	/* parallel_update : func_update may run on a worker thread alongside other parallel objects.
+	 * A parallel-safe update may write its own object and object_data, send messages and request its own destruction.
+	 * Other parallel objects are being written at the same time, so it may only read them through tds_object_get_prev_x/y,
+	 * the positions snapshotted before the phase started. Objects of non-parallel types are not written during the phase and can be read freely.
+	 * It must not teleport (that rewrites the snapshot others are reading), spawn objects, play sounds or touch any other engine state.
+	 * Messages sent during the parallel phase are queued and delivered afterwards, so their params must outlive the tick. */
+	int parallel_update;
+
+	/* msg_subscriptions : broadcast message ids the type handles, msg_subscription_count entries long.
+	 * Broadcasts only reach the instances of subscribed types. Messages sent to a handle are always delivered.
+	 * Leave it NULL to receive every broadcast, or use TDS_OBJECT_NO_BROADCASTS to receive none. */
+	const int* msg_subscriptions;
+	int msg_subscription_count;
+
 	void (*func_init)(struct tds_object* ptr);
 	void (*func_destroy)(struct tds_object* ptr);
 	void (*func_update)(struct tds_object* ptr);
 	void (*func_draw)(struct tds_object* ptr);
 	void (*func_msg)(struct tds_object* ptr, struct tds_object* from, int msg, void* param);
+
+	/* Runtime state, leave these zeroed in type definitions.
+	 * type_id is assigned by tds_object_type_cache_add. The instance list is maintained by tds_object_create and tds_object_free. */
+	int type_id;
+	unsigned int default_sprite_hash; /* Computed on first spawn. */
+	struct tds_object* instance_head, *instance_tail;
+	int instance_count;
+	struct tds_pool* pool; /* Slab storage for instances and their object_data, created on first spawn and freed with the type cache. */
 };
 
-struct tds_object* tds_object_create(struct tds_object_type* type, struct tds_handle_manager* hmgr, struct tds_sprite_cache* smgr, float x, float y, float z, struct tds_object_param* param_list);
+struct tds_object* tds_object_create(struct tds_object_type* type, struct tds_handle_manager* hmgr, struct tds_kinematics* kin, struct tds_sprite_cache* smgr, float x, float y, float z, struct tds_object_param* param_list, int param_count); /* Takes ownership of param_list, which must come from tds_malloc. */
 void tds_object_free(struct tds_object* ptr);
 
 void tds_object_set_sprite(struct tds_object* ptr, struct tds_sprite* sprite);
 void tds_object_send_msg(struct tds_object* ptr, int handle, int msg, void* data);
-vec4* tds_object_get_transform(struct tds_object* ptr);
+struct tds_affine* tds_object_get_transform(struct tds_object* ptr); /* Object space to world space at the interpolated render position, excluding z. */
 
-void tds_object_anim_update(struct tds_object* ptr);
+void tds_object_anim_update(struct tds_object* ptr, double time_ms); /* Called by the engine once per tick with the simulation time. */
 void tds_object_anim_start(struct tds_object* ptr);
 void tds_object_anim_pause(struct tds_object* ptr);
 
@@ -95,25 +136,84 @@ void tds_object_draw(struct tds_object* ptr);
 void tds_object_msg(struct tds_object* ptr, struct tds_object* sender, int msg, void* p);
 void tds_object_destroy(struct tds_object* ptr);
 
-void tds_object_update_sndsrc(struct tds_object* ptr); /* The sound source needs to be updated with pos, vel, etc. */
+void tds_object_update_sndsrc(struct tds_object* ptr); /* The sound source needs to be updated with pos, vel, etc. Only changed values reach OpenAL. */
+
+void tds_object_play_sound(struct tds_object* ptr, struct tds_sound_buffer* buf); /* Borrows a pooled source until the sound ends. Plays nothing if every source is busy. */
+void tds_object_stop_sound(struct tds_object* ptr);
 
 int tds_object_anim_oneshot_finished(struct tds_object* ptr);
 
+/* Kinematic state accessors. These index straight into the kinematics store, so they are cheap enough for inner loops.
+ * The engine integrates speed into position once per tick after every object has updated. */
+
+static inline float tds_object_get_x(struct tds_object* ptr) { return ptr->kin->x[ptr->slot]; }
+static inline float tds_object_get_y(struct tds_object* ptr) { return ptr->kin->y[ptr->slot]; }
+static inline float tds_object_get_xspeed(struct tds_object* ptr) { return ptr->kin->xspeed[ptr->slot]; }
+static inline float tds_object_get_yspeed(struct tds_object* ptr) { return ptr->kin->yspeed[ptr->slot]; }
+static inline float tds_object_get_cbox_width(struct tds_object* ptr) { return ptr->kin->cbox_width[ptr->slot]; }
+static inline float tds_object_get_cbox_height(struct tds_object* ptr) { return ptr->kin->cbox_height[ptr->slot]; }
+static inline int tds_object_get_layer(struct tds_object* ptr) { return ptr->kin->layer[ptr->slot]; }
+
+/* Position at the start of the current tick. Stable for the whole update phase, this is what parallel updates read from other parallel objects. */
+static inline float tds_object_get_prev_x(struct tds_object* ptr) { return ptr->kin->prev_x[ptr->slot]; }
+static inline float tds_object_get_prev_y(struct tds_object* ptr) { return ptr->kin->prev_y[ptr->slot]; }
+
+/* Interpolated position for drawing, between the previous and current tick. Cameras following an object should track this
+ * (see tds_camera_follow), tracking tds_object_get_x/y makes the view jitter against the drawn sprite. */
+static inline float tds_object_get_render_x(struct tds_object* ptr) { return ptr->kin->prev_x[ptr->slot] + (ptr->kin->x[ptr->slot] - ptr->kin->prev_x[ptr->slot]) * ptr->kin->alpha; }
+static inline float tds_object_get_render_y(struct tds_object* ptr) { return ptr->kin->prev_y[ptr->slot] + (ptr->kin->y[ptr->slot] - ptr->kin->prev_y[ptr->slot]) * ptr->kin->alpha; }
+
+static inline void tds_object_set_x(struct tds_object* ptr, float x) { ptr->kin->x[ptr->slot] = x; }
+static inline void tds_object_set_y(struct tds_object* ptr, float y) { ptr->kin->y[ptr->slot] = y; }
+static inline void tds_object_set_xspeed(struct tds_object* ptr, float xspeed) { ptr->kin->xspeed[ptr->slot] = xspeed; }
+static inline void tds_object_set_yspeed(struct tds_object* ptr, float yspeed) { ptr->kin->yspeed[ptr->slot] = yspeed; }
+static inline void tds_object_set_cbox_width(struct tds_object* ptr, float w) { ptr->kin->cbox_width[ptr->slot] = w; }
+static inline void tds_object_set_cbox_height(struct tds_object* ptr, float h) { ptr->kin->cbox_height[ptr->slot] = h; }
+static inline void tds_object_set_layer(struct tds_object* ptr, int layer) { ptr->kin->layer[ptr->slot] = layer; }
+
+/* Drawing interpolates from the position at the start of the tick, so tds_object_set_pos slides the sprite to the new spot over the next frame.
+ * That is right for motion. For warps, respawns, and anything repositioned from func_draw, use tds_object_teleport, which moves the snapshot too. */
+static inline void tds_object_set_pos(struct tds_object* ptr, float x, float y) {
+	ptr->kin->x[ptr->slot] = x;
+	ptr->kin->y[ptr->slot] = y;
+}
+
+static inline void tds_object_teleport(struct tds_object* ptr, float x, float y) {
+	/* Moves without interpolating from the old position on the next drawn frame. */
+	ptr->kin->x[ptr->slot] = ptr->kin->prev_x[ptr->slot] = x;
+	ptr->kin->y[ptr->slot] = ptr->kin->prev_y[ptr->slot] = y;
+}
+
+static inline void tds_object_set_speed(struct tds_object* ptr, float xspeed, float yspeed) {
+	ptr->kin->xspeed[ptr->slot] = xspeed;
+	ptr->kin->yspeed[ptr->slot] = yspeed;
+}
+
+static inline void tds_object_set_cbox(struct tds_object* ptr, float w, float h) {
+	ptr->kin->cbox_width[ptr->slot] = w;
+	ptr->kin->cbox_height[ptr->slot] = h;
+}
+
 /* We will have a nice and memory-safe API for manipulating object parameters.
  * All memory will already be allocated and managed by the runtime. Objects are just passed pointers to the original data.
+ * Returned pointers stay valid until the next set or unset call on the same object. String parameters are interned and read-only.
+ * Interned strings are never released until the engine is freed, so avoid setting an unbounded stream of distinct strings (counters, timestamps) as parameters.
  * There are also setter functions for convienence.
  * The setter functions create the parameter if it did not exist before. */
 
 int* tds_object_get_ipart(struct tds_object* ptr, unsigned int index);
-char* tds_object_get_spart(struct tds_object* ptr, unsigned int index);
+const char* tds_object_get_spart(struct tds_object* ptr, unsigned int index);
 unsigned int* tds_object_get_upart(struct tds_object* ptr, unsigned int index);
 float* tds_object_get_fpart(struct tds_object* ptr, unsigned int index);
 
 void tds_object_set_ipart(struct tds_object* ptr, unsigned int index, int value);
-void tds_object_set_spart(struct tds_object* ptr, unsigned int index, char* value, int value_size);
+void tds_object_set_spart(struct tds_object* ptr, unsigned int index, const char* value, int value_size);
 void tds_object_set_upart(struct tds_object* ptr, unsigned int index, unsigned int value);
 void tds_object_set_fpart(struct tds_object* ptr, unsigned int index, float value);
 
 void tds_object_unset(struct tds_object* ptr, unsigned int index);
 
-/* Objects do not need an API for iterating parameters. Only the engine needs to do this, and it is done by managing the linked list directly. Do NOT do this from object code or stuff could get nasty. */
+/* Objects do not need an API for iterating parameters. Only the engine needs to do this, and it is done by walking the sorted array directly. Do NOT do this from object code or stuff could get nasty. */
+
+const char* tds_object_param_intern(const char* value, int value_len); /* Returns the pooled copy of a string parameter value. Thread-safe. */
+void tds_object_param_sort(struct tds_object_param* params, int* count); /* Sorts by key and drops repeated keys, keeping the last one. */
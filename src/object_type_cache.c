@@ -5,57 +5,126 @@
 #include <stdlib.h>
 #include <string.h>
 
+static void _tds_object_type_cache_subscribe(struct tds_object_type_cache_subscription* sub, struct tds_object_type* type);
+
 struct tds_object_type_cache* tds_object_type_cache_create(void) {
 	struct tds_object_type_cache* output = tds_malloc(sizeof(struct tds_object_type_cache));
 
-	output->head = output->tail = NULL;
+	output->registry = tds_registry_create();
+
+	output->subscriptions = NULL;
+	output->subscription_count = output->subscription_capacity = 0;
+
+	memset(&output->all_msgs, 0, sizeof output->all_msgs);
 
 	return output;
 }
 
 void tds_object_type_cache_free(struct tds_object_type_cache* ptr) {
-	struct tds_object_type_cache_link* current = ptr->head, *tmp = NULL;
+	/* Types are usually static, so reset their runtime state for the next engine instance. */
+	for (int i = 0; i < ptr->registry->count; ++i) {
+		struct tds_object_type* type = tds_registry_get(ptr->registry, i);
+
+		if (type->pool) {
+			tds_pool_free(type->pool);
+			type->pool = NULL;
+		}
+
+		type->instance_head = type->instance_tail = NULL;
+		type->instance_count = 0;
+	}
+
+	for (int i = 0; i < ptr->subscription_count; ++i) {
+		tds_free(ptr->subscriptions[i].types);
+	}
 
-	while (current) {
-		tmp = current;
-		current = current->next;
-		tds_free(tmp);
+	if (ptr->subscriptions) {
+		tds_free(ptr->subscriptions);
 	}
 
+	if (ptr->all_msgs.types) {
+		tds_free(ptr->all_msgs.types);
+	}
+
+	tds_registry_free(ptr->registry);
 	tds_free(ptr);
 }
 
-void tds_object_type_cache_add(struct tds_object_type_cache* ptr, const char* object_type_name, struct tds_object_type* object_type) {
-	struct tds_object_type_cache_link* current = NULL;
-	current = tds_malloc(sizeof(struct tds_object_type_cache_link));
+int tds_object_type_cache_add(struct tds_object_type_cache* ptr, const char* object_type_name, struct tds_object_type* object_type) {
+	int type_id = tds_registry_add(ptr->registry, object_type_name, object_type);
 
-	current->prev = ptr->tail;
-	current->next = NULL;
-	current->name = object_type_name;
-	current->data = object_type;
+	object_type->type_id = type_id;
+
+	if (!object_type->func_msg) {
+		return type_id;
+	}
 
-	if (!ptr->head) {
-		ptr->head = current;
+	if (!object_type->msg_subscriptions) {
+		_tds_object_type_cache_subscribe(&ptr->all_msgs, object_type);
+		return type_id;
 	}
 
-	if (ptr->tail) {
-		ptr->tail->next = current;
+	for (int i = 0; i < object_type->msg_subscription_count; ++i) {
+		struct tds_object_type_cache_subscription* sub = tds_object_type_cache_get_subscribers(ptr, object_type->msg_subscriptions[i]);
+
+		if (!sub) {
+			if (ptr->subscription_count >= ptr->subscription_capacity) {
+				ptr->subscription_capacity = ptr->subscription_capacity ? ptr->subscription_capacity * 2 : 8;
+				ptr->subscriptions = tds_realloc(ptr->subscriptions, sizeof *ptr->subscriptions * ptr->subscription_capacity);
+			}
+
+			sub = ptr->subscriptions + ptr->subscription_count++;
+			memset(sub, 0, sizeof *sub);
+			sub->msg = object_type->msg_subscriptions[i];
+		}
+
+		_tds_object_type_cache_subscribe(sub, object_type);
 	}
 
-	ptr->tail = current;
+	return type_id;
 }
 
 struct tds_object_type* tds_object_type_cache_get(struct tds_object_type_cache* ptr, const char* object_type_name) {
-	struct tds_object_type_cache_link* current = ptr->head;
+	int type_id = tds_registry_find(ptr->registry, object_type_name);
 
-	while (current) {
-		if (!strcmp(current->name, object_type_name)) {
-			return current->data;
-		}
+	if (type_id == TDS_REGISTRY_NONE) {
+		tds_logf(TDS_LOG_WARNING, "[%s] not found in object_type cache\n", object_type_name);
+		return NULL;
+	}
+
+	return tds_registry_get(ptr->registry, type_id);
+}
+
+int tds_object_type_cache_find(struct tds_object_type_cache* ptr, const char* object_type_name) {
+	return tds_registry_find(ptr->registry, object_type_name);
+}
+
+struct tds_object_type* tds_object_type_cache_get_by_id(struct tds_object_type_cache* ptr, int type_id) {
+	return tds_registry_get(ptr->registry, type_id);
+}
 
-		current = current->next;
+struct tds_object_type_cache_subscription* tds_object_type_cache_get_subscribers(struct tds_object_type_cache* ptr, int msg) {
+	/* There are only a handful of distinct broadcast messages, a linear scan beats hashing here. */
+	for (int i = 0; i < ptr->subscription_count; ++i) {
+		if (ptr->subscriptions[i].msg == msg) {
+			return ptr->subscriptions + i;
+		}
 	}
 
-	tds_logf(TDS_LOG_WARNING, "[%s] not found in object_type cache\n", object_type_name);
 	return NULL;
 }
+
+static void _tds_object_type_cache_subscribe(struct tds_object_type_cache_subscription* sub, struct tds_object_type* type) {
+	for (int i = 0; i < sub->count; ++i) {
+		if (sub->types[i] == type) {
+			return;
+		}
+	}
+
+	if (sub->count >= sub->capacity) {
+		sub->capacity = sub->capacity ? sub->capacity * 2 : 4;
+		sub->types = tds_realloc(sub->types, sizeof *sub->types * sub->capacity);
+	}
+
+	sub->types[sub->count++] = type;
+}
@@ -1,20 +1,35 @@
 #pragma once
 
 #include "object.h"
+#include "registry.h"
 
-struct tds_object_type_cache_link {
-	struct tds_object_type* data;
-	struct tds_object_type_cache_link* next, *prev;
+/* Object types are indexed by interned name. Registration returns a stable numeric type id,
+ * so map loading and spawning code can resolve a type name once and reuse the id afterwards. */
 
-	const char* name;
+/* The cache also indexes types by the broadcast messages they subscribe to.
+ * Types without a subscription list are kept in a separate list and receive every broadcast. */
+
+struct tds_object_type_cache_subscription {
+	int msg;
+	struct tds_object_type** types;
+	int count, capacity;
 };
 
 struct tds_object_type_cache {
-	struct tds_object_type_cache_link* head, *tail;
+	struct tds_registry* registry;
+
+	struct tds_object_type_cache_subscription* subscriptions;
+	int subscription_count, subscription_capacity;
+	struct tds_object_type_cache_subscription all_msgs;
 };
 
 struct tds_object_type_cache* tds_object_type_cache_create(void);
 void tds_object_type_cache_free(struct tds_object_type_cache* ptr);
 
-void tds_object_type_cache_add(struct tds_object_type_cache* ptr, const char* object_type_name, struct tds_object_type* obj);
+int tds_object_type_cache_add(struct tds_object_type_cache* ptr, const char* object_type_name, struct tds_object_type* obj); /* Returns the type id, also stored in obj->type_id. */
 struct tds_object_type* tds_object_type_cache_get(struct tds_object_type_cache* ptr, const char* object_type_name);
+
+int tds_object_type_cache_find(struct tds_object_type_cache* ptr, const char* object_type_name); /* Returns the type id or TDS_REGISTRY_NONE. */
+struct tds_object_type* tds_object_type_cache_get_by_id(struct tds_object_type_cache* ptr, int type_id);
+
+struct tds_object_type_cache_subscription* tds_object_type_cache_get_subscribers(struct tds_object_type_cache* ptr, int msg); /* Types subscribed to [msg], or NULL if there are none. */
@@ -18,13 +18,15 @@ struct tds_object_type obj_editor_cursor_type = {
 	.func_update = obj_editor_cursor_update,
 	.func_draw = obj_editor_cursor_draw,
 	.func_msg = obj_editor_cursor_msg,
+	.msg_subscriptions = (const int[]) {TDS_MSG_MOUSE_PRESSED, TDS_MSG_MOUSE_RELEASED},
+	.msg_subscription_count = 2,
 	.save = 0
 };
 
 void obj_editor_cursor_init(struct tds_object* ptr) {
 	tds_input_set_mouse(tds_engine_global->input_handle, 0.0f, 0.0f);
 
-	ptr->layer = 10;
+	tds_object_set_layer(ptr, 10);
 }
 
 void obj_editor_cursor_destroy(struct tds_object* ptr) {
@@ -36,17 +38,18 @@ void obj_editor_cursor_update(struct tds_object* ptr) {
 void obj_editor_cursor_draw(struct tds_object* ptr) {
 	struct obj_editor_cursor_data* data = ptr->object_data;
 
-	ptr->x = tds_engine_global->input_handle->mx * OBJ_EDITOR_CURSOR_SENS + tds_engine_global->camera_handle->x;
-	ptr->y = tds_engine_global->input_handle->my * -OBJ_EDITOR_CURSOR_SENS + tds_engine_global->camera_handle->y;
+	float cursor_x = tds_engine_global->input_handle->mx * OBJ_EDITOR_CURSOR_SENS + tds_engine_global->camera_handle->x;
+	float cursor_y = tds_engine_global->input_handle->my * -OBJ_EDITOR_CURSOR_SENS + tds_engine_global->camera_handle->y;
+
+	tds_object_teleport(ptr, cursor_x, cursor_y);
 
 	int angle_mod = tds_input_map_get_key(tds_engine_global->input_map_handle, GLFW_KEY_LEFT_SHIFT, 0);
 
 	if (data->drag) {
 		if (angle_mod) {
-			data->drag->angle = atan2(ptr->y - data->drag->y, ptr->x - data->drag->x);
+			data->drag->angle = atan2(cursor_y - tds_object_get_y(data->drag), cursor_x - tds_object_get_x(data->drag));
 		} else {
-			data->drag->x = ptr->x + data->x_offset;
-			data->drag->y = ptr->y + data->y_offset;
+			tds_object_teleport(data->drag, cursor_x + data->x_offset, cursor_y + data->y_offset);
 		}
 	}
 }
@@ -66,8 +69,8 @@ void obj_editor_cursor_msg(struct tds_object* ptr, struct tds_object* sender, in
 			for (int i = 0; i < result.size; ++i) {
 				if (tds_collision_get_overlap(result.buffer[i], ptr)) {
 					data->drag = data->last = result.buffer[i];
-					data->x_offset = result.buffer[i]->x - ptr->x;
-					data->y_offset = result.buffer[i]->y - ptr->y;
+					data->x_offset = tds_object_get_x(result.buffer[i]) - tds_object_get_x(ptr);
+					data->y_offset = tds_object_get_y(result.buffer[i]) - tds_object_get_y(ptr);
 					break;
 				}
 			}
@@ -11,6 +11,8 @@ struct tds_object_type obj_editor_selector_type = {
 	.func_update = obj_editor_selector_update,
 	.func_draw = obj_editor_selector_draw,
 	.func_msg = obj_editor_selector_msg,
+	.msg_subscriptions = TDS_OBJECT_NO_BROADCASTS, /* Only receives TDS_MSG_EDIT_TARGET directly from the cursor. */
+	.msg_subscription_count = 0,
 	.save = 0
 };
 
@@ -28,12 +30,10 @@ void obj_editor_selector_draw(struct tds_object* ptr) {
 
 	ptr->visible = (data->target != 0);
 
-	data->target->x = ptr->x;
-	data->target->y = ptr->y;
+	tds_object_teleport(data->target, tds_object_get_x(ptr), tds_object_get_y(ptr));
 	data->target->angle = ptr->angle;
 
-	ptr->cbox_width = 1.0f;
-	ptr->cbox_height = 1.0f;
+	tds_object_set_cbox(ptr, 1.0f, 1.0f);
 }
 
 void obj_editor_selector_msg(struct tds_object* ptr, struct tds_object* sender, int msg, void* param) {
@@ -42,8 +42,7 @@ void obj_editor_selector_msg(struct tds_object* ptr, struct tds_object* sender,
 	switch(msg) {
 	case TDS_MSG_EDIT_TARGET:
 		data->target = param;
-		ptr->x = data->target->x;
-		ptr->y = data->target->y;
+		tds_object_teleport(ptr, tds_object_get_x(data->target), tds_object_get_y(data->target));
 		ptr->angle = data->target->angle;
 		break;
 	}
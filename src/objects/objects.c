@@ -16,7 +16,7 @@ void tds_create_editor_objects(void) {
 	}
 
 	editor_mode = TDS_EDITOR_MODE_OBJECTS;
-	editor_cursor = tds_object_create(&obj_editor_cursor_type, tds_engine_global->object_buffer, tds_engine_global->sc_handle, 0.0f, 0.0f, 0.0f, NULL);
+	editor_cursor = tds_engine_spawn(tds_engine_global, &obj_editor_cursor_type, 0.0f, 0.0f, 0.0f, NULL, 0);
 
 	/* We want to create a selector for each object in the buffer with the save flag. */
 	struct tds_handle_manager* hmgr = tds_engine_global->object_buffer;
@@ -53,6 +53,6 @@ int tds_editor_get_mode(void) {
 }
 
 void tds_editor_add_selector(struct tds_object* ptr) {
-	struct tds_object* new_obj = tds_object_create(&obj_editor_selector_type, tds_engine_global->object_buffer, tds_engine_global->sc_handle, ptr->x, ptr->y, 0.0f, NULL);
+	struct tds_object* new_obj = tds_engine_spawn(tds_engine_global, &obj_editor_selector_type, tds_object_get_x(ptr), tds_object_get_y(ptr), 0.0f, NULL, 0);
 	tds_object_msg(new_obj, NULL, TDS_MSG_EDIT_TARGET, ptr);
 }
@@ -0,0 +1,78 @@
+#include "pool.h"
+#include "memory.h"
+#include "log.h"
+
+#include <string.h>
+
+static void _tds_pool_add_slab(struct tds_pool* ptr);
+
+struct tds_pool* tds_pool_create(unsigned int elem_size, unsigned int slab_count) {
+	struct tds_pool* output = tds_malloc(sizeof *output);
+	memset(output, 0, sizeof *output);
+
+	if (elem_size < sizeof(void*)) {
+		elem_size = sizeof(void*); /* Free elements store the free list link in place. */
+	}
+
+	output->elem_size = (elem_size + TDS_POOL_ALIGN - 1) & ~(TDS_POOL_ALIGN - 1);
+	output->slab_count = slab_count ? slab_count : 1;
+
+	return output;
+}
+
+void tds_pool_free(struct tds_pool* ptr) {
+	if (ptr->live_count) {
+		tds_logf(TDS_LOG_WARNING, "Freeing pool with %d live elements.\n", ptr->live_count);
+	}
+
+	for (int i = 0; i < ptr->slab_list_count; ++i) {
+		tds_free(ptr->slabs[i]);
+	}
+
+	if (ptr->slabs) {
+		tds_free(ptr->slabs);
+	}
+
+	tds_free(ptr);
+}
+
+void* tds_pool_alloc(struct tds_pool* ptr) {
+	if (!ptr->free_head) {
+		_tds_pool_add_slab(ptr);
+	}
+
+	void* output = ptr->free_head;
+	ptr->free_head = *(void**) output;
+	ptr->live_count++;
+
+	/* Recycled elements still hold their last owner's data. Hand them out zeroed, like tds_malloc. */
+	memset(output, 0, ptr->elem_size);
+
+	return output;
+}
+
+void tds_pool_release(struct tds_pool* ptr, void* elem) {
+	*(void**) elem = ptr->free_head;
+	ptr->free_head = elem;
+	ptr->live_count--;
+}
+
+static void _tds_pool_add_slab(struct tds_pool* ptr) {
+	if (ptr->slab_list_count >= ptr->slab_list_capacity) {
+		ptr->slab_list_capacity = ptr->slab_list_capacity ? ptr->slab_list_capacity * 2 : 4;
+		ptr->slabs = tds_realloc(ptr->slabs, sizeof *ptr->slabs * ptr->slab_list_capacity);
+	}
+
+	char* slab = tds_malloc(ptr->elem_size * ptr->slab_count);
+
+	tds_logf(TDS_LOG_DEBUG, "Adding pool slab of %d elements (%d bytes each).\n", ptr->slab_count, ptr->elem_size);
+
+	ptr->slabs[ptr->slab_list_count++] = slab;
+
+	/* Thread the new slab onto the free list in address order, so consecutive allocations are adjacent. */
+	for (int i = ptr->slab_count - 1; i >= 0; --i) {
+		void* elem = slab + (size_t) i * ptr->elem_size;
+		*(void**) elem = ptr->free_head;
+		ptr->free_head = elem;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+/* The pool is a slab allocator for fixed-size elements.
+ * Memory is requested in slabs of [slab_count] elements and never returned until the pool is freed.
+ * Released elements go on a free list and are handed out again before a new slab is allocated,
+ * so steady-state allocate/release cycles do no heap traffic and live elements stay close together. */
+
+#define TDS_POOL_ALIGN 16 /* Matches the malloc alignment guarantee on 64-bit targets. */
+
+struct tds_pool {
+	unsigned int elem_size, slab_count;
+
+	void** slabs;
+	int slab_list_count, slab_list_capacity;
+
+	void* free_head;
+	int live_count;
+};
+
+struct tds_pool* tds_pool_create(unsigned int elem_size, unsigned int slab_count);
+void tds_pool_free(struct tds_pool* ptr); /* Frees every slab; outstanding elements become invalid. */
+
+void* tds_pool_alloc(struct tds_pool* ptr); /* Elements are aligned to TDS_POOL_ALIGN and zeroed, like tds_malloc. */
+void tds_pool_release(struct tds_pool* ptr, void* elem);
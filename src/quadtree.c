@@ -91,6 +91,35 @@ int tds_quadtree_insert(struct tds_quadtree* ptr, float l, float r, float t, flo
 	}
 }
 
+int tds_quadtree_remove(struct tds_quadtree* ptr, float l, float r, float t, float b, void* data) {
+	/* Insertion puts an entry in the deepest node that fully contains it, so only those nodes need to be searched. */
+
+	if (!ptr || !(l >= ptr->l && r <= ptr->r && t <= ptr->t && b >= ptr->b)) {
+		return 0;
+	}
+
+	if (!ptr->leaf) {
+		if (tds_quadtree_remove(ptr->lt, l, r, t, b, data) || tds_quadtree_remove(ptr->lb, l, r, t, b, data) || tds_quadtree_remove(ptr->rb, l, r, t, b, data) || tds_quadtree_remove(ptr->rt, l, r, t, b, data)) {
+			return 1;
+		}
+	}
+
+	struct tds_quadtree_entry** cur = &ptr->entry_list;
+
+	while (*cur) {
+		if ((*cur)->data == data) {
+			struct tds_quadtree_entry* tmp = *cur;
+			*cur = tmp->next;
+			tds_free(tmp);
+			return 1;
+		}
+
+		cur = &(*cur)->next;
+	}
+
+	return 0;
+}
+
 void tds_quadtree_walk(struct tds_quadtree* ptr, float l, float r, float t, float b, void* usr, void (*callback)(void*, void*)) {
 	if (r < ptr->l || l > ptr->r || t < ptr->b || b > ptr->t) {
 		return;
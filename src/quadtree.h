@@ -19,6 +19,7 @@ void tds_quadtree_free(struct tds_quadtree* ptr);
  * it will NOT free the data which has been passed to it. */
 
 int tds_quadtree_insert(struct tds_quadtree* ptr, float l, float r, float t, float b, void* data); /* Returns 1 if successfully inserted into node or any children */
+int tds_quadtree_remove(struct tds_quadtree* ptr, float l, float r, float t, float b, void* data); /* Removes an entry inserted with the same bounds. Returns 1 if it was found. */
 void tds_quadtree_walk(struct tds_quadtree* ptr, float l, float r, float t, float b, void* usr, void (*user_callback)(void*, void*));
 
 /* user_callback is called with (usr, <quadtree entry data>) */
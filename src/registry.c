@@ -0,0 +1,138 @@
+#include "registry.h"
+#include "memory.h"
+#include "log.h"
+
+#include <string.h>
+
+#define TDS_REGISTRY_INITIAL_SIZE 16
+
+static void _tds_registry_rehash(struct tds_registry* ptr, unsigned int table_size);
+
+unsigned int tds_registry_hash(const char* key) {
+	/* 32-bit FNV-1a. */
+	unsigned int hash = 2166136261u;
+
+	while (*key) {
+		hash ^= (unsigned char) *key++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+struct tds_registry* tds_registry_create(void) {
+	struct tds_registry* output = tds_malloc(sizeof *output);
+
+	output->entries = NULL;
+	output->count = output->capacity = 0;
+	output->table = NULL;
+	output->table_size = 0;
+
+	_tds_registry_rehash(output, TDS_REGISTRY_INITIAL_SIZE);
+
+	return output;
+}
+
+void tds_registry_free(struct tds_registry* ptr) {
+	for (int i = 0; i < ptr->count; ++i) {
+		tds_free(ptr->entries[i].key);
+	}
+
+	tds_free(ptr->entries);
+	tds_free(ptr->table);
+	tds_free(ptr);
+}
+
+int tds_registry_add(struct tds_registry* ptr, const char* key, void* data) {
+	unsigned int hash = tds_registry_hash(key);
+	int id = tds_registry_find_hashed(ptr, key, hash);
+
+	if (id != TDS_REGISTRY_NONE) {
+		ptr->entries[id].data = data;
+		return id;
+	}
+
+	if (ptr->count >= ptr->capacity) {
+		ptr->capacity = ptr->capacity ? ptr->capacity * 2 : TDS_REGISTRY_INITIAL_SIZE;
+		ptr->entries = tds_realloc(ptr->entries, sizeof *ptr->entries * ptr->capacity);
+	}
+
+	/* Keep the load factor under 1/2 so probe runs stay short. */
+	if ((unsigned int) (ptr->count + 1) * 2 > ptr->table_size) {
+		_tds_registry_rehash(ptr, ptr->table_size * 2);
+	}
+
+	id = ptr->count++;
+
+	int key_len = strlen(key);
+	struct tds_registry_entry* entry = ptr->entries + id;
+
+	entry->key = tds_malloc(key_len + 1);
+	memcpy(entry->key, key, key_len + 1);
+	entry->hash = hash;
+	entry->data = data;
+
+	unsigned int slot = hash & (ptr->table_size - 1);
+
+	while (ptr->table[slot]) {
+		slot = (slot + 1) & (ptr->table_size - 1);
+	}
+
+	ptr->table[slot] = id + 1;
+
+	return id;
+}
+
+int tds_registry_find(struct tds_registry* ptr, const char* key) {
+	return tds_registry_find_hashed(ptr, key, tds_registry_hash(key));
+}
+
+int tds_registry_find_hashed(struct tds_registry* ptr, const char* key, unsigned int hash) {
+	unsigned int slot = hash & (ptr->table_size - 1);
+
+	while (ptr->table[slot]) {
+		struct tds_registry_entry* entry = ptr->entries + ptr->table[slot] - 1;
+
+		if (entry->hash == hash && !strcmp(entry->key, key)) {
+			return ptr->table[slot] - 1;
+		}
+
+		slot = (slot + 1) & (ptr->table_size - 1);
+	}
+
+	return TDS_REGISTRY_NONE;
+}
+
+void* tds_registry_get(struct tds_registry* ptr, int id) {
+	if (id < 0 || id >= ptr->count) {
+		return NULL;
+	}
+
+	return ptr->entries[id].data;
+}
+
+const char* tds_registry_get_key(struct tds_registry* ptr, int id) {
+	if (id < 0 || id >= ptr->count) {
+		return NULL;
+	}
+
+	return ptr->entries[id].key;
+}
+
+static void _tds_registry_rehash(struct tds_registry* ptr, unsigned int table_size) {
+	tds_free(ptr->table);
+
+	ptr->table_size = table_size;
+	ptr->table = tds_malloc(sizeof *ptr->table * table_size);
+	memset(ptr->table, 0, sizeof *ptr->table * table_size);
+
+	for (int i = 0; i < ptr->count; ++i) {
+		unsigned int slot = ptr->entries[i].hash & (table_size - 1);
+
+		while (ptr->table[slot]) {
+			slot = (slot + 1) & (table_size - 1);
+		}
+
+		ptr->table[slot] = i + 1;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+/* The registry maps interned string keys to dense integer ids.
+ * Keys are copied on insertion and hashed once, the index is an open-addressed table with linear probing.
+ * Ids are assigned in insertion order and never change, so callers can resolve a name once and keep the id. */
+
+#define TDS_REGISTRY_NONE -1
+
+struct tds_registry_entry {
+	char* key;
+	unsigned int hash;
+	void* data;
+};
+
+struct tds_registry {
+	struct tds_registry_entry* entries;
+	int count, capacity;
+
+	int* table; /* Slots hold entry id + 1, 0 means empty. */
+	unsigned int table_size;
+};
+
+unsigned int tds_registry_hash(const char* key);
+
+struct tds_registry* tds_registry_create(void);
+void tds_registry_free(struct tds_registry* ptr); /* Frees the keys and index, the caller owns the data pointers. */
+
+int tds_registry_add(struct tds_registry* ptr, const char* key, void* data); /* Returns the id. An existing key keeps its id and takes the new data. */
+int tds_registry_find(struct tds_registry* ptr, const char* key); /* Returns TDS_REGISTRY_NONE if the key is not present. */
+int tds_registry_find_hashed(struct tds_registry* ptr, const char* key, unsigned int hash);
+
+void* tds_registry_get(struct tds_registry* ptr, int id); /* Returns NULL for an invalid id. */
+const char* tds_registry_get_key(struct tds_registry* ptr, int id);
@@ -4,6 +4,7 @@
 #include "object.h"
 #include "block_map.h"
 #include "engine.h"
+#include "headless.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -35,13 +36,15 @@ struct tds_render* tds_render_create(struct tds_camera* camera, struct tds_handl
 
 	output->blur_passes = 0; /* no extra blur passes for now */
 
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
-	glDisable(GL_CULL_FACE);
-	glBlendEquation(GL_FUNC_ADD);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	if (!tds_headless) {
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glDisable(GL_CULL_FACE);
+		glBlendEquation(GL_FUNC_ADD);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glActiveTexture(GL_TEXTURE0);
+		glActiveTexture(GL_TEXTURE0);
+	}
 
 	unsigned int display_width = tds_engine_global->display_handle->desc.width, display_height = tds_engine_global->display_handle->desc.height;
 	output->lightmap_rt = tds_rt_create(display_width, display_height);
@@ -92,6 +95,10 @@ void tds_render_free(struct tds_render* ptr) {
 }
 
 void tds_render_clear(struct tds_render* ptr) {
+	if (tds_headless) {
+		return;
+	}
+
 	tds_rt_bind(ptr->post_rt1);
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -117,6 +124,11 @@ void tds_render_set_ambient_color(struct tds_render* ptr, float r, float g, floa
 
 void tds_render_draw(struct tds_render* ptr, struct tds_world** world_list, int world_count, struct tds_render_flat* flat_world, struct tds_render_flat* flat_overlay) {
 	/* Drawing will be done linearly on a per-layer basis, using a list of occluded objects. */
+
+	if (tds_headless) {
+		return;
+	}
+
 	int render_objects = 1;
 
 	if (ptr->enable_wireframe) {
@@ -152,10 +164,12 @@ void tds_render_draw(struct tds_render* ptr, struct tds_world** world_list, int
 			continue;
 		}
 
-		if (target->layer < min_layer) {
-			min_layer = target->layer;
-		} else if (target->layer > max_layer) {
-			max_layer = target->layer;
+		int target_layer = tds_object_get_layer(target);
+
+		if (target_layer < min_layer) {
+			min_layer = target_layer;
+		} else if (target_layer > max_layer) {
+			max_layer = target_layer;
 		}
 	}
 
@@ -181,7 +195,7 @@ void tds_render_draw(struct tds_render* ptr, struct tds_world** world_list, int
 
 			struct tds_object* target = (struct tds_object*) ptr->object_buffer->buffer[j].data;
 
-			if (target->layer == i) {
+			if (tds_object_get_layer(target) == i) {
 				object_rendered[j] = 1;
 				_tds_render_object(ptr, target, i, ptr->shader_passthrough);
 			}
@@ -346,12 +360,11 @@ void tds_render_draw(struct tds_render* ptr, struct tds_world** world_list, int
 void _tds_render_object(struct tds_render* ptr, struct tds_object* obj, int layer, struct tds_shader* shader) {
 	/* Grab the sprite VBO, compose the render transform, and send the data to the shaders. */
 
-	vec4* sprite_transform = tds_sprite_get_transform(obj->sprite_handle);
-	vec4* object_transform = tds_object_get_transform(obj);
+	struct tds_affine obj_transform_full;
+	tds_affine_mul(&obj_transform_full, tds_object_get_transform(obj), tds_sprite_get_transform(obj->sprite_handle));
 
-	mat4x4 transform, obj_transform_full;
-	mat4x4_mul(obj_transform_full, object_transform, sprite_transform);
-	mat4x4_mul(transform, ptr->camera_handle->mat_transform, obj_transform_full);
+	mat4x4 transform;
+	tds_affine_apply_mat4x4(transform, ptr->camera_handle->mat_transform, &obj_transform_full, obj->z);
 
 	tds_shader_set_color(shader, obj->r, obj->g, obj->b, obj->a);
 	tds_shader_set_transform(shader, (float*) *transform);
@@ -378,7 +391,7 @@ void _tds_render_hblock_callback(void* usr, void* data) {
 
 	/* The translation must take into account that the block size may not be aligned. */
 	float render_x = TDS_WORLD_BLOCK_SIZE * (cur->x - world->width / 2.0f + cur->w / 2.0f);
-	float render_y = TDS_WORLD_BLOCK_SIZE * (cur->y - world->height / 2.0f + 0.5f);
+	float render_y = TDS_WORLD_BLOCK_SIZE * (cur->y - world->height / 2.0f + cur->h / 2.0f);
 
 	if (ptr->enable_aabb) {
 		float camera_left = tds_engine_global->camera_handle->x - tds_engine_global->camera_handle->width / 2.0f;
@@ -388,8 +401,8 @@ void _tds_render_hblock_callback(void* usr, void* data) {
 
 		float block_left = render_x - cur->w / 2.0f * TDS_WORLD_BLOCK_SIZE;
 		float block_right = render_x + cur->w / 2.0f * TDS_WORLD_BLOCK_SIZE;
-		float block_top = render_y + TDS_WORLD_BLOCK_SIZE / 2.0f;
-		float block_bottom = render_y - TDS_WORLD_BLOCK_SIZE / 2.0f;
+		float block_top = render_y + cur->h / 2.0f * TDS_WORLD_BLOCK_SIZE;
+		float block_bottom = render_y - cur->h / 2.0f * TDS_WORLD_BLOCK_SIZE;
 
 		if (block_left > camera_right || block_right < camera_left || block_bottom > camera_top || block_top < camera_bottom) {
 			return;
@@ -5,6 +5,7 @@
 #include "engine.h"
 #include "log.h"
 #include "vertex_buffer.h"
+#include "headless.h"
 
 #include <math.h>
 
@@ -23,8 +24,10 @@ struct tds_render_flat* tds_render_flat_create(void) {
 	tds_render_flat_set_mode(output, TDS_RENDER_COORD_REL_SCREENSPACE);
 	tds_render_flat_set_color(output, 1.0f, 1.0f, 1.0f, 1.0f);
 
-	glLineWidth(0.2f);
-	glDisable(GL_LINE_SMOOTH);
+	if (!tds_headless) {
+		glLineWidth(0.2f);
+		glDisable(GL_LINE_SMOOTH);
+	}
 
 	return output;
 }
@@ -38,6 +41,10 @@ void tds_render_flat_free(struct tds_render_flat* ptr) {
 }
 
 void tds_render_flat_clear(struct tds_render_flat* ptr) {
+	if (tds_headless) {
+		return;
+	}
+
 	tds_rt_bind(ptr->rt_backbuf);
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
@@ -55,6 +62,10 @@ void tds_render_flat_set_color(struct tds_render_flat* ptr, float r, float g, fl
 }
 
 void tds_render_flat_line(struct tds_render_flat* ptr, float x1, float y1, float x2, float y2) {
+	if (tds_headless) {
+		return;
+	}
+
 	struct tds_vertex verts[2] = {0};
 
 	transform_coords(ptr, x1, y1, &verts[0].x, &verts[0].y);
@@ -79,6 +90,10 @@ void tds_render_flat_line(struct tds_render_flat* ptr, float x1, float y1, float
 }
 
 void tds_render_flat_quad(struct tds_render_flat* ptr, float left, float right, float top, float bottom, struct tds_texture* tex) {
+	if (tds_headless) {
+		return;
+	}
+
 	struct tds_vertex verts[6] = {
 		{0.0f, 0.0f, 0.0f, 0.0f, 1.0f},
 		{0.0f, 0.0f, 0.0f, 1.0f, 0.0f},
@@ -122,6 +137,10 @@ void tds_render_flat_quad(struct tds_render_flat* ptr, float left, float right,
 }
 
 void tds_render_flat_point(struct tds_render_flat* ptr, float x, float y) {
+	if (tds_headless) {
+		return;
+	}
+
 	struct tds_vertex verts[1] = {0};
 	transform_coords(ptr, x, y, &verts[0].x, &verts[0].y);
 
@@ -142,6 +161,10 @@ void tds_render_flat_point(struct tds_render_flat* ptr, float x, float y) {
 }
 
 void tds_render_flat_text(struct tds_render_flat* ptr, struct tds_font* font, char* buf, int buflen, float _x, float _y, tds_render_alignment align, struct tds_string_format* formats) {
+	if (tds_headless) {
+		return;
+	}
+
 	if (!font) {
 		return;
 	}
@@ -0,0 +1,223 @@
+#include "replay.h"
+#include "engine.h"
+#include "memory.h"
+#include "log.h"
+
+#include <string.h>
+
+static void _tds_replay_write_tick(struct tds_replay* ptr, struct tds_input* input);
+static int _tds_replay_read_tick(struct tds_replay* ptr, struct tds_input* input);
+static void _tds_replay_reserve_events(struct tds_replay* ptr, int count);
+
+struct tds_replay* tds_replay_create_record(const char* filename, unsigned int seed) {
+	FILE* fd = fopen(filename, "wb");
+
+	if (!fd) {
+		tds_logf(TDS_LOG_WARNING, "Failed to open [%s] for recording.\n", filename);
+		return NULL;
+	}
+
+	struct tds_replay* output = tds_malloc(sizeof *output);
+	memset(output, 0, sizeof *output);
+
+	output->fd = fd;
+	output->mode = TDS_REPLAY_RECORD;
+	output->seed = seed;
+
+	uint32_t header[3] = {TDS_REPLAY_MAGIC, TDS_REPLAY_VERSION, seed};
+	fwrite(header, sizeof header, 1, fd);
+
+	tds_logf(TDS_LOG_MESSAGE, "Recording input to [%s] with seed %u.\n", filename, seed);
+
+	return output;
+}
+
+struct tds_replay* tds_replay_create_play(const char* filename) {
+	FILE* fd = fopen(filename, "rb");
+
+	if (!fd) {
+		tds_logf(TDS_LOG_WARNING, "Failed to open replay [%s].\n", filename);
+		return NULL;
+	}
+
+	uint32_t header[3] = {0};
+
+	if (!fread(header, sizeof header, 1, fd) || header[0] != TDS_REPLAY_MAGIC || header[1] != TDS_REPLAY_VERSION) {
+		tds_logf(TDS_LOG_WARNING, "[%s] is not a version %d replay.\n", filename, TDS_REPLAY_VERSION);
+		fclose(fd);
+		return NULL;
+	}
+
+	struct tds_replay* output = tds_malloc(sizeof *output);
+	memset(output, 0, sizeof *output);
+
+	output->fd = fd;
+	output->mode = TDS_REPLAY_PLAY;
+	output->seed = header[2];
+
+	tds_logf(TDS_LOG_MESSAGE, "Playing replay [%s] with seed %u.\n", filename, output->seed);
+
+	return output;
+}
+
+void tds_replay_free(struct tds_replay* ptr) {
+	tds_logf(TDS_LOG_MESSAGE, "Closing replay after %lu ticks.\n", ptr->tick);
+
+	fclose(ptr->fd);
+
+	if (ptr->events) {
+		tds_free(ptr->events);
+	}
+
+	tds_free(ptr);
+}
+
+void tds_replay_push_event(struct tds_replay* ptr, int msg, int code) {
+	if (ptr->mode != TDS_REPLAY_RECORD) {
+		return;
+	}
+
+	_tds_replay_reserve_events(ptr, ptr->event_count + 1);
+
+	ptr->events[ptr->event_count].msg = msg;
+	ptr->events[ptr->event_count].code = code;
+	ptr->event_count++;
+}
+
+int tds_replay_tick(struct tds_replay* ptr, struct tds_input* input) {
+	if (ptr->mode == TDS_REPLAY_RECORD) {
+		_tds_replay_write_tick(ptr, input);
+	} else if (!_tds_replay_read_tick(ptr, input)) {
+		tds_logf(TDS_LOG_MESSAGE, "Replay finished after %lu ticks.\n", ptr->tick);
+		return 0;
+	}
+
+	ptr->tick++;
+
+	for (int i = 0; i < ptr->event_count; ++i) {
+		int code = ptr->events[i].code;
+		tds_engine_broadcast(tds_engine_global, ptr->events[i].msg, &code);
+	}
+
+	ptr->event_count = 0;
+
+	return 1;
+}
+
+static void _tds_replay_write_tick(struct tds_replay* ptr, struct tds_input* input) {
+	unsigned char kb_bits[TDS_REPLAY_KB_BYTES] = {0};
+	int kb_count = sizeof input->kb_state / sizeof *input->kb_state;
+	int mb_count = sizeof input->mb_state / sizeof *input->mb_state;
+	int controller_count = sizeof input->controller_state / sizeof *input->controller_state;
+
+	for (int i = 0; i < kb_count; ++i) {
+		if (input->kb_state[i]) {
+			kb_bits[i / 8] |= 1 << (i % 8);
+		}
+	}
+
+	uint8_t mb_bits = 0;
+
+	for (int i = 0; i < mb_count; ++i) {
+		if (input->mb_state[i]) {
+			mb_bits |= 1 << i;
+		}
+	}
+
+	uint32_t controller_bits = 0;
+
+	for (int i = 0; i < controller_count; ++i) {
+		if (input->controller_state[i]) {
+			controller_bits |= 1u << i;
+		}
+	}
+
+	/* Axes are only stored while a controller is connected. */
+	uint8_t controller_info[2] = {input->controller_present != 0, input->controller_present ? sizeof input->controller_axis_state / sizeof *input->controller_axis_state : 0};
+	uint16_t event_count = ptr->event_count;
+
+	fwrite(kb_bits, sizeof kb_bits, 1, ptr->fd);
+	fwrite(&mb_bits, sizeof mb_bits, 1, ptr->fd);
+	fwrite(&controller_bits, sizeof controller_bits, 1, ptr->fd);
+	fwrite(controller_info, sizeof controller_info, 1, ptr->fd);
+	fwrite(input->controller_axis_state, sizeof *input->controller_axis_state, controller_info[1], ptr->fd);
+	fwrite(&input->mx, sizeof input->mx, 1, ptr->fd);
+	fwrite(&input->my, sizeof input->my, 1, ptr->fd);
+	fwrite(&event_count, sizeof event_count, 1, ptr->fd);
+	fwrite(ptr->events, sizeof *ptr->events, event_count, ptr->fd);
+}
+
+static int _tds_replay_read_tick(struct tds_replay* ptr, struct tds_input* input) {
+	unsigned char kb_bits[TDS_REPLAY_KB_BYTES] = {0};
+	uint8_t mb_bits = 0;
+	uint32_t controller_bits = 0;
+	uint8_t controller_info[2] = {0};
+	uint16_t event_count = 0;
+
+	if (!fread(kb_bits, sizeof kb_bits, 1, ptr->fd)) {
+		return 0;
+	}
+
+	if (!fread(&mb_bits, sizeof mb_bits, 1, ptr->fd) || !fread(&controller_bits, sizeof controller_bits, 1, ptr->fd) || !fread(controller_info, sizeof controller_info, 1, ptr->fd)) {
+		tds_logf(TDS_LOG_WARNING, "Truncated replay record at tick %lu.\n", ptr->tick);
+		return 0;
+	}
+
+	int kb_count = sizeof input->kb_state / sizeof *input->kb_state;
+	int mb_count = sizeof input->mb_state / sizeof *input->mb_state;
+	int controller_count = sizeof input->controller_state / sizeof *input->controller_state;
+	int axis_count = sizeof input->controller_axis_state / sizeof *input->controller_axis_state;
+
+	if (controller_info[1] > axis_count || fread(input->controller_axis_state, sizeof *input->controller_axis_state, controller_info[1], ptr->fd) != controller_info[1]) {
+		tds_logf(TDS_LOG_WARNING, "Corrupt controller axes in replay at tick %lu.\n", ptr->tick);
+		return 0;
+	}
+
+	if (!fread(&input->mx, sizeof input->mx, 1, ptr->fd) || !fread(&input->my, sizeof input->my, 1, ptr->fd) || !fread(&event_count, sizeof event_count, 1, ptr->fd)) {
+		tds_logf(TDS_LOG_WARNING, "Truncated replay record at tick %lu.\n", ptr->tick);
+		return 0;
+	}
+
+	_tds_replay_reserve_events(ptr, event_count);
+
+	if (fread(ptr->events, sizeof *ptr->events, event_count, ptr->fd) != event_count) {
+		tds_logf(TDS_LOG_WARNING, "Truncated replay events at tick %lu.\n", ptr->tick);
+		return 0;
+	}
+
+	ptr->event_count = event_count;
+
+	for (int i = 0; i < kb_count; ++i) {
+		input->kb_state[i] = (kb_bits[i / 8] >> (i % 8)) & 1;
+	}
+
+	for (int i = 0; i < mb_count; ++i) {
+		input->mb_state[i] = (mb_bits >> i) & 1;
+	}
+
+	for (int i = 0; i < controller_count; ++i) {
+		input->controller_state[i] = (controller_bits >> i) & 1;
+	}
+
+	for (int i = controller_info[1]; i < axis_count; ++i) {
+		input->controller_axis_state[i] = 0.0f;
+	}
+
+	input->controller_present = controller_info[0];
+
+	return 1;
+}
+
+static void _tds_replay_reserve_events(struct tds_replay* ptr, int count) {
+	if (count <= ptr->event_capacity) {
+		return;
+	}
+
+	ptr->event_capacity = ptr->event_capacity ? ptr->event_capacity * 2 : 16;
+
+	if (ptr->event_capacity < count) {
+		ptr->event_capacity = count;
+	}
+
+	ptr->events = tds_realloc(ptr->events, sizeof *ptr->events * ptr->event_capacity);
+}
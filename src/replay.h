@@ -0,0 +1,47 @@
+#pragma once
+
+#include "input.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* The replay system records the engine's input, one record per update tick, and plays it back later.
+ * Recording starts with the random seed, so a replay reproduces the same session on any build.
+ *
+ * While a replay is recording or playing, key and mouse button events are queued and broadcast at the start of the next tick
+ * instead of from the GLFW callbacks, so the recorded session and its playback deliver them at the same point.
+ * During playback, live input is ignored.
+ *
+ * File layout, little endian as written by the host :
+ *   header : magic, version, seed (uint32 each)
+ *   per tick : keyboard bitset, mouse button bits, controller button bits, controller flag and axis count,
+ *              axis values, mouse x/y, event count, then the events. */
+
+#define TDS_REPLAY_MAGIC 0x52534454 /* "TDSR" */
+#define TDS_REPLAY_VERSION 1
+
+#define TDS_REPLAY_RECORD 0
+#define TDS_REPLAY_PLAY 1
+
+#define TDS_REPLAY_KB_BYTES ((sizeof ((struct tds_input*) 0)->kb_state / sizeof *((struct tds_input*) 0)->kb_state + 7) / 8)
+
+struct tds_replay_event {
+	int32_t msg, code;
+};
+
+struct tds_replay {
+	FILE* fd;
+	int mode;
+	unsigned int seed;
+	unsigned long tick;
+
+	struct tds_replay_event* events; /* Recording : events since the last tick. Playback : events of the current tick. */
+	int event_count, event_capacity;
+};
+
+struct tds_replay* tds_replay_create_record(const char* filename, unsigned int seed);
+struct tds_replay* tds_replay_create_play(const char* filename); /* Returns NULL if the file is missing or not a replay. */
+void tds_replay_free(struct tds_replay* ptr);
+
+void tds_replay_push_event(struct tds_replay* ptr, int msg, int code); /* Ignored during playback. */
+int tds_replay_tick(struct tds_replay* ptr, struct tds_input* input); /* Records or restores the input for one tick and broadcasts its events. Returns 0 once playback reaches the end. */
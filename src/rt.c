@@ -2,6 +2,9 @@
 #include "log.h"
 #include "memory.h"
 #include "engine.h"
+#include "headless.h"
+
+#include <string.h>
 
 #include <GLXW/glxw.h>
 
@@ -11,6 +14,13 @@ struct tds_rt* tds_rt_create(unsigned int width, unsigned int height) {
 
 	tds_logf(TDS_LOG_DEBUG, "Initializing framebuffers with size %dx%d\n", width, height);
 
+	if (tds_headless) {
+		memset(output, 0, sizeof *output);
+		output->width = width;
+		output->height = height;
+		return output;
+	}
+
 	if (glGetError() != GL_NO_ERROR) {
 		tds_logf(TDS_LOG_WARNING, "GL error present before RT init\n");
 	}
@@ -80,6 +90,10 @@ void tds_rt_free(struct tds_rt* ptr) {
 }
 
 void tds_rt_bind(struct tds_rt* ptr) {
+	if (tds_headless) {
+		return;
+	}
+
 	unsigned int t_fb = ptr ? ptr->gl_fb : 0;
 	glBindFramebuffer(GL_FRAMEBUFFER, t_fb);
 
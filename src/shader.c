@@ -1,6 +1,9 @@
 #include "shader.h"
 #include "memory.h"
 #include "log.h"
+#include "headless.h"
+
+#include <string.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -13,6 +16,11 @@ struct tds_shader* tds_shader_create(const char* vs, const char* gs, const char*
 	int status = 0;
 	struct tds_shader* output = tds_malloc(sizeof *output);
 
+	if (tds_headless) {
+		memset(output, 0, sizeof *output);
+		return output;
+	}
+
 	output->prg = glCreateProgram();
 
 	if (vs) {
@@ -62,6 +70,11 @@ struct tds_shader* tds_shader_create_tfb(const char* vs, const char* gs, const c
 	int status = 0;
 	struct tds_shader* output = tds_malloc(sizeof *output);
 
+	if (tds_headless) {
+		memset(output, 0, sizeof *output);
+		return output;
+	}
+
 	output->prg = glCreateProgram();
 
 	if (vs) {
@@ -110,6 +123,11 @@ struct tds_shader* tds_shader_create_tfb(const char* vs, const char* gs, const c
 }
 
 void tds_shader_free(struct tds_shader* ptr) {
+	if (!ptr->prg) {
+		tds_free(ptr);
+		return;
+	}
+
 	glUseProgram(0);
 
 	if (ptr->f_vs) {
@@ -167,27 +185,51 @@ unsigned int _compile_shader(const char* filename, GLenum type) {
 }
 
 void tds_shader_bind(struct tds_shader* ptr) {
+	if (!ptr->prg) {
+		return;
+	}
+
 	glUseProgram(ptr->prg);
 }
 
 void tds_shader_set_transform(struct tds_shader* ptr, float* transform) {
+	if (!ptr->prg) {
+		return;
+	}
+
 	glUniformMatrix4fv(ptr->u_transform, 1, GL_FALSE, transform);
 }
 
 void tds_shader_set_color(struct tds_shader* ptr, float r, float g, float b, float a) {
+	if (!ptr->prg) {
+		return;
+	}
+
 	glUniform4f(ptr->u_color, r, g, b, a);
 }
 
 void tds_shader_set_direction(struct tds_shader* ptr, float x, float y) {
+	if (!ptr->prg) {
+		return;
+	}
+
 	glUniform2f(ptr->u_direction, x, y);
 }
 
 void tds_shader_bind_texture(struct tds_shader* ptr, unsigned int texture) {
+	if (!ptr->prg) {
+		return;
+	}
+
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, texture);
 }
 
 void tds_shader_bind_texture_alt(struct tds_shader* ptr, unsigned int texture) {
+	if (!ptr->prg) {
+		return;
+	}
+
 	glActiveTexture(GL_TEXTURE1);
 	glBindTexture(GL_TEXTURE_2D, texture);
 }
@@ -1,6 +1,7 @@
 #include "sound_buffer.h"
 #include "memory.h"
 #include "log.h"
+#include "headless.h"
 
 #include <AL/al.h>
 
@@ -11,6 +12,11 @@ static unsigned int _tds_sound_buffer_load(char* filename);
 struct tds_sound_buffer* tds_sound_buffer_create(char* filename) {
 	struct tds_sound_buffer* output = tds_malloc(sizeof(struct tds_sound_buffer));
 
+	if (tds_headless) {
+		output->buffer_id = 0; /* No device to upload to, skip decoding entirely. */
+		return output;
+	}
+
 	output->buffer_id = _tds_sound_buffer_load(filename);
 
 	tds_logf(TDS_LOG_DEBUG, "Loaded sound [%s] into buffer id %d.\n", filename, output->buffer_id);
@@ -19,7 +25,10 @@ struct tds_sound_buffer* tds_sound_buffer_create(char* filename) {
 }
 
 void tds_sound_buffer_free(struct tds_sound_buffer* ptr) {
-	alDeleteBuffers(1, &ptr->buffer_id);
+	if (ptr->buffer_id) {
+		alDeleteBuffers(1, &ptr->buffer_id);
+	}
+
 	tds_free(ptr);
 }
 
@@ -8,46 +8,50 @@
 struct tds_sound_cache* tds_sound_cache_create(void) {
 	struct tds_sound_cache* output = tds_malloc(sizeof(struct tds_sound_cache));
 
-	output->head = NULL;
+	output->registry = tds_registry_create();
 
 	return output;
 }
 
 void tds_sound_cache_free(struct tds_sound_cache* ptr) {
-	struct tds_sound_cache_link* current = ptr->head, *tmp = NULL;
-
-	while (current) {
-		tds_sound_buffer_free(current->data);
-		tmp = current;
-		current = current->next;
-		tds_free(tmp);
+	for (int i = 0; i < ptr->registry->count; ++i) {
+		tds_sound_buffer_free(tds_registry_get(ptr->registry, i));
 	}
 
+	tds_registry_free(ptr->registry);
 	tds_free(ptr);
 }
 
 void tds_sound_cache_add(struct tds_sound_cache* ptr, const char* sound_name, struct tds_sound_buffer* sound) {
-	struct tds_sound_cache_link* current = NULL;
-	current = tds_malloc(sizeof(struct tds_sound_cache_link));
+	int sound_id = tds_registry_find(ptr->registry, sound_name);
 
-	current->next = ptr->head;
-	current->name = sound_name;
-	current->data = sound;
+	if (sound_id != TDS_REGISTRY_NONE && tds_registry_get(ptr->registry, sound_id) != sound) {
+		tds_logf(TDS_LOG_WARNING, "[%s] is already in the sound cache, replacing it\n", sound_name);
+		tds_sound_buffer_free(tds_registry_get(ptr->registry, sound_id));
+	}
 
-	ptr->head = current;
+	tds_registry_add(ptr->registry, sound_name, sound);
 }
 
 struct tds_sound_buffer* tds_sound_cache_get(struct tds_sound_cache* ptr, const char* sound_name) {
-	struct tds_sound_cache_link* current = ptr->head;
-
-	while (current) {
-		if (!strcmp(current->name, sound_name)) {
-			return current->data;
-		}
+	int sound_id = tds_registry_find(ptr->registry, sound_name);
 
-		current = current->next;
+	if (sound_id == TDS_REGISTRY_NONE) {
+		tds_logf(TDS_LOG_WARNING, "[%s] not found in sound cache\n", sound_name);
+		return NULL;
 	}
 
-	tds_logf(TDS_LOG_CRITICAL, "%s not found in sound cache\n", sound_name);
-	return current->data;
+	return tds_registry_get(ptr->registry, sound_id);
+}
+
+int tds_sound_cache_find(struct tds_sound_cache* ptr, const char* sound_name) {
+	return tds_registry_find(ptr->registry, sound_name);
+}
+
+int tds_sound_cache_find_hashed(struct tds_sound_cache* ptr, const char* sound_name, unsigned int hash) {
+	return tds_registry_find_hashed(ptr->registry, sound_name, hash);
+}
+
+struct tds_sound_buffer* tds_sound_cache_get_by_id(struct tds_sound_cache* ptr, int sound_id) {
+	return tds_registry_get(ptr->registry, sound_id);
 }
@@ -1,20 +1,18 @@
 #pragma once
 
 #include "sound_buffer.h"
-
-struct tds_sound_cache_link {
-	struct tds_sound_buffer* data;
-	struct tds_sound_cache_link* next;
-
-	const char* name;
-};
+#include "registry.h"
 
 struct tds_sound_cache {
-	struct tds_sound_cache_link* head;
+	struct tds_registry* registry;
 };
 
 struct tds_sound_cache* tds_sound_cache_create(void);
 void tds_sound_cache_free(struct tds_sound_cache* ptr);
 
 void tds_sound_cache_add(struct tds_sound_cache* ptr, const char* sound_name, struct tds_sound_buffer* obj);
-struct tds_sound_buffer* tds_sound_cache_get(struct tds_sound_cache* ptr, const char* sound_name);
+struct tds_sound_buffer* tds_sound_cache_get(struct tds_sound_cache* ptr, const char* sound_name); /* Returns NULL on a miss. */
+
+int tds_sound_cache_find(struct tds_sound_cache* ptr, const char* sound_name); /* Returns the sound id or TDS_REGISTRY_NONE. */
+int tds_sound_cache_find_hashed(struct tds_sound_cache* ptr, const char* sound_name, unsigned int hash); /* hash from tds_registry_hash. */
+struct tds_sound_buffer* tds_sound_cache_get_by_id(struct tds_sound_cache* ptr, int sound_id);
@@ -1,12 +1,21 @@
 #include "sound_manager.h"
 #include "log.h"
 #include "memory.h"
+#include "headless.h"
 
 #include <stdlib.h>
 
 struct tds_sound_manager* tds_sound_manager_create(void) {
 	struct tds_sound_manager* output = tds_malloc(sizeof(struct tds_sound_manager));
 
+	output->source_count = output->free_count = 0;
+
+	if (tds_headless) {
+		output->device = NULL;
+		output->context = NULL;
+		return output;
+	}
+
 	output->device = alcOpenDevice(NULL);
 
 	if (!output->device) {
@@ -39,6 +48,19 @@ struct tds_sound_manager* tds_sound_manager_create(void) {
 }
 
 void tds_sound_manager_free(struct tds_sound_manager* ptr) {
+	if (!ptr->device) {
+		tds_free(ptr);
+		return;
+	}
+
+	for (int i = 0; i < ptr->source_count; ++i) {
+		if (ptr->sources[i]->owner_ref) {
+			*ptr->sources[i]->owner_ref = NULL;
+		}
+
+		tds_sound_source_free(ptr->sources[i]);
+	}
+
 	alcMakeContextCurrent(NULL);
 	alcDestroyContext(ptr->context);
 	alcCloseDevice(ptr->device);
@@ -46,5 +68,63 @@ void tds_sound_manager_free(struct tds_sound_manager* ptr) {
 }
 
 void tds_sound_manager_set_pos(struct tds_sound_manager* ptr, float x, float y) {
+	if (!ptr->device) {
+		return;
+	}
+
 	alListener3f(AL_POSITION, x, y, 0.0f);
 }
+
+struct tds_sound_source* tds_sound_manager_acquire(struct tds_sound_manager* ptr, struct tds_sound_source** owner_ref) {
+	struct tds_sound_source* output = NULL;
+
+	if (!ptr->device) {
+		*owner_ref = NULL;
+		return NULL; /* Headless, objects never hold a source. */
+	}
+
+	if (ptr->free_count) {
+		output = ptr->free_sources[--ptr->free_count];
+	} else if (ptr->source_count < TDS_SOUND_MANAGER_MAX_SOURCES) {
+		output = ptr->sources[ptr->source_count++] = tds_sound_source_create();
+	} else {
+		/* Sources which finished since the last update can be reclaimed early. */
+		tds_sound_manager_update(ptr);
+
+		if (!ptr->free_count) {
+			tds_logf(TDS_LOG_DEBUG, "All %d sound sources are playing, dropping sound.\n", TDS_SOUND_MANAGER_MAX_SOURCES);
+			*owner_ref = NULL;
+			return NULL;
+		}
+
+		output = ptr->free_sources[--ptr->free_count];
+	}
+
+	output->owner_ref = owner_ref;
+	*owner_ref = output;
+
+	return output;
+}
+
+void tds_sound_manager_release(struct tds_sound_manager* ptr, struct tds_sound_source* src) {
+	if (!src->owner_ref) {
+		return;
+	}
+
+	tds_sound_source_stop(src);
+
+	*src->owner_ref = NULL;
+	src->owner_ref = NULL;
+
+	ptr->free_sources[ptr->free_count++] = src;
+}
+
+void tds_sound_manager_update(struct tds_sound_manager* ptr) {
+	for (int i = 0; i < ptr->source_count; ++i) {
+		struct tds_sound_source* src = ptr->sources[i];
+
+		if (src->owner_ref && !tds_sound_source_get_playing(src)) {
+			tds_sound_manager_release(ptr, src);
+		}
+	}
+}
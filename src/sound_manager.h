@@ -3,13 +3,31 @@
 #include <AL/al.h>
 #include <AL/alc.h>
 
+#include "sound_source.h"
+
+/* The sound manager owns a bounded pool of sources. Objects acquire one when they start playing,
+ * and tds_sound_manager_update returns finished sources to the pool once per frame.
+ * AL sources are generated on first use, so the pool never asks the driver for more than TDS_SOUND_MANAGER_MAX_SOURCES. */
+
+#define TDS_SOUND_MANAGER_MAX_SOURCES 64
+
 struct tds_sound_manager {
 	ALCdevice* device;
 	ALCcontext* context;
 	unsigned int source;
+
+	struct tds_sound_source* sources[TDS_SOUND_MANAGER_MAX_SOURCES];
+	int source_count;
+
+	struct tds_sound_source* free_sources[TDS_SOUND_MANAGER_MAX_SOURCES];
+	int free_count;
 };
 
 struct tds_sound_manager* tds_sound_manager_create(void);
 void tds_sound_manager_free(struct tds_sound_manager* ptr);
 
 void tds_sound_manager_set_pos(struct tds_sound_manager* ptr, float x, float y);
+
+struct tds_sound_source* tds_sound_manager_acquire(struct tds_sound_manager* ptr, struct tds_sound_source** owner_ref); /* Stores the source in *owner_ref, returns NULL if every source is playing. */
+void tds_sound_manager_release(struct tds_sound_manager* ptr, struct tds_sound_source* src); /* Stops the source and clears its owner's reference. */
+void tds_sound_manager_update(struct tds_sound_manager* ptr); /* Reclaims sources which finished playing. */
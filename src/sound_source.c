@@ -4,6 +4,8 @@
 
 #include <AL/al.h>
 
+#include <stdlib.h>
+
 struct tds_sound_source* tds_sound_source_create(void) {
 	struct tds_sound_source* output = tds_malloc(sizeof(struct tds_sound_source));
 
@@ -15,6 +17,11 @@ struct tds_sound_source* tds_sound_source_create(void) {
 	alSource3f(output->source, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
 	alSourcei(output->source, AL_LOOPING, 0);
 
+	output->x = output->y = output->xspeed = output->yspeed = 0.0f;
+	output->vol = 1.0f;
+	output->loop = 0;
+	output->owner_ref = NULL;
+
 	return output;
 }
 
@@ -25,18 +32,40 @@ void tds_sound_source_free(struct tds_sound_source* ptr) {
 }
 
 void tds_sound_source_set_pos(struct tds_sound_source* ptr, float x, float y) {
+	if (ptr->x == x && ptr->y == y) {
+		return;
+	}
+
+	ptr->x = x;
+	ptr->y = y;
 	alSource3f(ptr->source, AL_POSITION, x, y, 0.0f);
 }
 
 void tds_sound_source_set_vel(struct tds_sound_source* ptr, float x, float y) {
+	if (ptr->xspeed == x && ptr->yspeed == y) {
+		return;
+	}
+
+	ptr->xspeed = x;
+	ptr->yspeed = y;
 	alSource3f(ptr->source, AL_VELOCITY, x, y, 0.0f);
 }
 
 void tds_sound_source_set_vol(struct tds_sound_source* ptr, float vol) {
+	if (ptr->vol == vol) {
+		return;
+	}
+
+	ptr->vol = vol;
 	alSourcef(ptr->source, AL_GAIN, vol);
 }
 
 void tds_sound_source_set_loop(struct tds_sound_source* ptr, int loop) {
+	if (ptr->loop == loop) {
+		return;
+	}
+
+	ptr->loop = loop;
 	alSourcei(ptr->source, AL_LOOPING, loop);
 }
 
@@ -52,3 +81,10 @@ void tds_sound_source_play(struct tds_sound_source* ptr) {
 void tds_sound_source_stop(struct tds_sound_source* ptr) {
 	alSourceStop(ptr->source);
 }
+
+int tds_sound_source_get_playing(struct tds_sound_source* ptr) {
+	ALint state = AL_STOPPED;
+	alGetSourcei(ptr->source, AL_SOURCE_STATE, &state);
+
+	return state == AL_PLAYING || state == AL_PAUSED;
+}
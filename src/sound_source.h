@@ -3,10 +3,18 @@
 /* A sound object contains an AL source and an AL buffer. */
 /* Buffers are shared, they should be retrieved from the sound_buffer_cache. */
 
+/* Sources are owned by the sound manager's pool; objects borrow one only while they are playing.
+ * The setters remember the last value sent to OpenAL and skip the driver call when nothing changed. */
+
 #include "sound_buffer.h"
 
 struct tds_sound_source {
 	unsigned int source;
+
+	float x, y, xspeed, yspeed, vol;
+	int loop;
+
+	struct tds_sound_source** owner_ref; /* Cleared by the sound manager when the source is reclaimed. NULL while the source is free. */
 };
 
 struct tds_sound_source* tds_sound_source_create(void);
@@ -19,3 +27,4 @@ void tds_sound_source_set_loop(struct tds_sound_source* ptr, int loop);
 void tds_sound_source_load_buffer(struct tds_sound_source* ptr, struct tds_sound_buffer* buf);
 void tds_sound_source_play(struct tds_sound_source* ptr);
 void tds_sound_source_stop(struct tds_sound_source* ptr);
+int tds_sound_source_get_playing(struct tds_sound_source* ptr);
@@ -48,21 +48,21 @@ void tds_sprite_free(struct tds_sprite* ptr) {
 	tds_free(ptr);
 }
 
-vec4* tds_sprite_get_transform(struct tds_sprite* ptr) {
-	/* Sprites have several transformations, including position, rotations, and scaling */
+struct tds_affine* tds_sprite_get_transform(struct tds_sprite* ptr) {
+	/* Sprites are offset, then rotated around the object origin. Sprite members are modified directly, so the cache compares against the inputs it was built from. */
 
-	mat4x4 pos, rot, scale;
-	mat4x4 rotscale;
-
-	mat4x4_identity(ptr->mat_transform);
-	mat4x4_identity(ptr->mat_id);
+	if (ptr->transform_valid && ptr->transform_offset_x == ptr->offset_x && ptr->transform_offset_y == ptr->offset_y && ptr->transform_offset_angle == ptr->offset_angle) {
+		return &ptr->transform;
+	}
 
-	mat4x4_translate(pos, ptr->offset_x, ptr->offset_y, 0.0f);
-	mat4x4_rotate_Z(rot, ptr->mat_id, ptr->offset_angle);
-	mat4x4_scale(scale, ptr->mat_id, ptr->offset_scale);
+	ptr->transform_offset_x = ptr->offset_x;
+	ptr->transform_offset_y = ptr->offset_y;
+	ptr->transform_offset_angle = ptr->offset_angle;
+	ptr->transform_valid = 1;
 
-	mat4x4_mul(rotscale, ptr->mat_transform, rot);
-	mat4x4_mul(ptr->mat_transform, rotscale, pos);
+	struct tds_affine offset = {1.0f, 0.0f, 0.0f, 1.0f, ptr->offset_x, ptr->offset_y}, rot;
+	tds_affine_rotate_translate(&rot, ptr->offset_angle, 0.0f, 0.0f);
+	tds_affine_mul(&ptr->transform, &rot, &offset);
 
-	return ptr->mat_transform;
+	return &ptr->transform;
 }
@@ -3,6 +3,7 @@
 #include "vertex_buffer.h"
 #include "texture.h"
 #include "linmath.h"
+#include "affine.h"
 
 /* The sprite structure will interpret tilesets and prepare the GL textures.
  *
@@ -22,7 +23,9 @@ struct tds_sprite {
 	float width, height;
 	float animation_rate; /* Delay in ms */
 
-	mat4x4 mat_transform, mat_id;
+	struct tds_affine transform; /* Cached by tds_sprite_get_transform, rebuilt when the offsets change. */
+	float transform_offset_x, transform_offset_y, transform_offset_angle;
+	int transform_valid;
 
 	struct tds_texture* texture;
 	struct tds_vertex_buffer* vbo_handle;
@@ -37,4 +40,4 @@ void tds_sprite_free(struct tds_sprite* ptr);
  * Changing the sprite should be done by manipulating the members.
  */
 
-vec4* tds_sprite_get_transform(struct tds_sprite* ptr);
+struct tds_affine* tds_sprite_get_transform(struct tds_sprite* ptr);
@@ -8,46 +8,51 @@
 struct tds_sprite_cache* tds_sprite_cache_create(void) {
 	struct tds_sprite_cache* output = tds_malloc(sizeof(struct tds_sprite_cache));
 
-	output->head = NULL;
+	output->registry = tds_registry_create();
 
 	return output;
 }
 
 void tds_sprite_cache_free(struct tds_sprite_cache* ptr) {
-	struct tds_sprite_cache_link* current = ptr->head, *tmp = NULL;
-
-	while (current) {
-		tds_sprite_free(current->data);
-		tmp = current;
-		current = current->next;
-		tds_free(tmp);
+	for (int i = 0; i < ptr->registry->count; ++i) {
+		tds_sprite_free(tds_registry_get(ptr->registry, i));
 	}
 
+	tds_registry_free(ptr->registry);
 	tds_free(ptr);
 }
 
 void tds_sprite_cache_add(struct tds_sprite_cache* ptr, const char* sprite_name, struct tds_sprite* sprite) {
-	struct tds_sprite_cache_link* current = NULL;
-	current = tds_malloc(sizeof(struct tds_sprite_cache_link));
+	int sprite_id = tds_registry_find(ptr->registry, sprite_name);
 
-	current->next = ptr->head;
-	current->name = sprite_name;
-	current->data = sprite;
+	if (sprite_id != TDS_REGISTRY_NONE && tds_registry_get(ptr->registry, sprite_id) != sprite) {
+		/* Sprites are registered at load time, before any object could hold the old one. */
+		tds_logf(TDS_LOG_WARNING, "[%s] is already in the sprite cache, replacing it\n", sprite_name);
+		tds_sprite_free(tds_registry_get(ptr->registry, sprite_id));
+	}
 
-	ptr->head = current;
+	tds_registry_add(ptr->registry, sprite_name, sprite);
 }
 
 struct tds_sprite* tds_sprite_cache_get(struct tds_sprite_cache* ptr, const char* sprite_name) {
-	struct tds_sprite_cache_link* current = ptr->head;
-
-	while (current) {
-		if (!strcmp(current->name, sprite_name)) {
-			return current->data;
-		}
+	int sprite_id = tds_registry_find(ptr->registry, sprite_name);
 
-		current = current->next;
+	if (sprite_id == TDS_REGISTRY_NONE) {
+		tds_logf(TDS_LOG_WARNING, "[%s] not found in sprite cache\n", sprite_name);
+		return NULL;
 	}
 
-	tds_logf(TDS_LOG_CRITICAL, "%s not found in sprite cache\n", sprite_name);
-	return current->data;
+	return tds_registry_get(ptr->registry, sprite_id);
+}
+
+int tds_sprite_cache_find(struct tds_sprite_cache* ptr, const char* sprite_name) {
+	return tds_registry_find(ptr->registry, sprite_name);
+}
+
+int tds_sprite_cache_find_hashed(struct tds_sprite_cache* ptr, const char* sprite_name, unsigned int hash) {
+	return tds_registry_find_hashed(ptr->registry, sprite_name, hash);
+}
+
+struct tds_sprite* tds_sprite_cache_get_by_id(struct tds_sprite_cache* ptr, int sprite_id) {
+	return tds_registry_get(ptr->registry, sprite_id);
 }
@@ -1,20 +1,18 @@
 #pragma once
 
 #include "sprite.h"
-
-struct tds_sprite_cache_link {
-	struct tds_sprite* data;
-	struct tds_sprite_cache_link* next;
-
-	const char* name;
-};
+#include "registry.h"
 
 struct tds_sprite_cache {
-	struct tds_sprite_cache_link* head;
+	struct tds_registry* registry;
 };
 
 struct tds_sprite_cache* tds_sprite_cache_create(void);
 void tds_sprite_cache_free(struct tds_sprite_cache* ptr);
 
 void tds_sprite_cache_add(struct tds_sprite_cache* ptr, const char* sprite_name, struct tds_sprite* obj);
-struct tds_sprite* tds_sprite_cache_get(struct tds_sprite_cache* ptr, const char* sprite_name);
+struct tds_sprite* tds_sprite_cache_get(struct tds_sprite_cache* ptr, const char* sprite_name); /* Returns NULL on a miss. */
+
+int tds_sprite_cache_find(struct tds_sprite_cache* ptr, const char* sprite_name); /* Returns the sprite id or TDS_REGISTRY_NONE. */
+int tds_sprite_cache_find_hashed(struct tds_sprite_cache* ptr, const char* sprite_name, unsigned int hash); /* hash from tds_registry_hash. */
+struct tds_sprite* tds_sprite_cache_get_by_id(struct tds_sprite_cache* ptr, int sprite_id);
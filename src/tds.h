@@ -16,6 +16,7 @@
 #include "input_map.h"
 #include "key_map.h"
 #include "key_names.h"
+#include "kinematics.h"
 #include "linmath.h"
 #include "log.h"
 #include "memory.h"
@@ -23,7 +24,10 @@
 #include "msg.h"
 #include "object.h"
 #include "object_type_cache.h"
+#include "registry.h"
+#include "headless.h"
 #include "render.h"
+#include "replay.h"
 #include "savestate.h"
 #include "script.h"
 #include "signal.h"
@@ -2,6 +2,7 @@
 #include "memory.h"
 #include "log.h"
 #include "stb_image.h"
+#include "headless.h"
 
 #include <GLXW/glxw.h>
 #include <string.h>
@@ -29,10 +30,14 @@ struct tds_texture* tds_texture_create(const char* filename, int tile_x, int til
 		memcpy(img_data + i * img_rw, stb_data + (h - 1) * img_rw - i * img_rw, w * 4 * sizeof *img_data);
 	}
 
-	glGenTextures(1, &output->gl_id);
-	glBindTexture(GL_TEXTURE_2D, output->gl_id);
+	output->gl_id = 0;
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, img_data);
+	if (!tds_headless) {
+		glGenTextures(1, &output->gl_id);
+		glBindTexture(GL_TEXTURE_2D, output->gl_id);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, img_data);
+	}
 	stbi_image_free(stb_data);
 	tds_free(img_data);
 
@@ -71,11 +76,13 @@ struct tds_texture* tds_texture_create(const char* filename, int tile_x, int til
 		}
 	}
 
-	glBindTexture(GL_TEXTURE_2D, output->gl_id);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	if (output->gl_id) {
+		glBindTexture(GL_TEXTURE_2D, output->gl_id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
 
 	output->filename = tds_malloc(strlen(filename) + 1);
 	memcpy(output->filename, filename, strlen(filename));
@@ -87,13 +94,19 @@ struct tds_texture* tds_texture_create(const char* filename, int tile_x, int til
 void tds_texture_set_wrap(struct tds_texture* ptr, int wrap_x, int wrap_y) {
 	tds_logf(TDS_LOG_DEBUG, "Setting texture to wrap mode (%d, %d)\n", wrap_x, wrap_y);
 
+	if (!ptr->gl_id) {
+		return;
+	}
+
 	glBindTexture(GL_TEXTURE_2D, ptr->gl_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_x ? GL_REPEAT : GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_y ? GL_REPEAT : GL_CLAMP_TO_EDGE);
 }
 
 void tds_texture_free(struct tds_texture* ptr) {
-	glDeleteTextures(1, &ptr->gl_id);
+	if (ptr->gl_id) {
+		glDeleteTextures(1, &ptr->gl_id);
+	}
 
 	if (ptr->filename) {
 		tds_free(ptr->filename);
@@ -8,46 +8,43 @@
 struct tds_texture_cache* tds_texture_cache_create(void) {
 	struct tds_texture_cache* output = tds_malloc(sizeof(struct tds_texture_cache));
 
-	output->head = NULL;
+	output->registry = tds_registry_create();
 
 	return output;
 }
 
 void tds_texture_cache_free(struct tds_texture_cache* ptr) {
-	struct tds_texture_cache_link* current = ptr->head, *tmp = NULL;
-
-	while (current) {
-		tds_texture_free(current->data);
-		tmp = current;
-		current = current->next;
-		tds_free(tmp);
+	for (int i = 0; i < ptr->registry->count; ++i) {
+		tds_texture_free(tds_registry_get(ptr->registry, i));
 	}
 
+	tds_registry_free(ptr->registry);
 	tds_free(ptr);
 }
 
 struct tds_texture* tds_texture_cache_get(struct tds_texture_cache* ptr, const char* texture_name, int tile_x, int tile_y, int wrap_x, int wrap_y) {
-	struct tds_texture_cache_link* current = ptr->head;
-
-	while (current) {
-		if (!strcmp(current->data->filename, texture_name)) {
-			tds_logf(TDS_LOG_DEBUG, "Matched [%s] with stored [%s]\n", texture_name, current->data->filename);
-			return current->data;
-		}
+	int texture_id = tds_registry_find(ptr->registry, texture_name);
 
-		current = current->next;
+	if (texture_id != TDS_REGISTRY_NONE) {
+		tds_logf(TDS_LOG_DEBUG, "Matched [%s] with stored texture %d\n", texture_name, texture_id);
+		return tds_registry_get(ptr->registry, texture_id);
 	}
 
-	current = tds_malloc(sizeof(struct tds_texture_cache_link));
-
-	current->next = ptr->head;
-	ptr->head = current;
-
-	current->data = tds_texture_create(texture_name, tile_x, tile_y);
+	struct tds_texture* output = tds_texture_create(texture_name, tile_x, tile_y);
 
 	if (wrap_x || wrap_y) {
-		tds_texture_set_wrap(current->data, wrap_x, wrap_y);
+		tds_texture_set_wrap(output, wrap_x, wrap_y);
 	}
 
-	return current->data;
+	tds_registry_add(ptr->registry, texture_name, output);
+
+	return output;
+}
+
+int tds_texture_cache_find(struct tds_texture_cache* ptr, const char* texture_name) {
+	return tds_registry_find(ptr->registry, texture_name);
+}
+
+struct tds_texture* tds_texture_cache_get_by_id(struct tds_texture_cache* ptr, int texture_id) {
+	return tds_registry_get(ptr->registry, texture_id);
 }
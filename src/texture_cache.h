@@ -1,17 +1,16 @@
 #pragma once
 
 #include "texture.h"
-
-struct tds_texture_cache_link {
-	struct tds_texture* data;
-	struct tds_texture_cache_link* next;
-};
+#include "registry.h"
 
 struct tds_texture_cache {
-	struct tds_texture_cache_link* head;
+	struct tds_registry* registry; /* Keyed by texture filename. */
 };
 
 struct tds_texture_cache* tds_texture_cache_create(void);
 void tds_texture_cache_free(struct tds_texture_cache* ptr);
 
-struct tds_texture* tds_texture_cache_get(struct tds_texture_cache* ptr, const char* texture_name, int tile_x, int tile_y, int wrap_x, int wrap_y);
+struct tds_texture* tds_texture_cache_get(struct tds_texture_cache* ptr, const char* texture_name, int tile_x, int tile_y, int wrap_x, int wrap_y); /* Loads the texture on a miss. */
+
+int tds_texture_cache_find(struct tds_texture_cache* ptr, const char* texture_name); /* Returns the texture id or TDS_REGISTRY_NONE, never loads. */
+struct tds_texture* tds_texture_cache_get_by_id(struct tds_texture_cache* ptr, int texture_id);
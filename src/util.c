@@ -68,32 +68,34 @@ void tds_util_hsv_to_rgb(float h, float s, float l, float* r, float* b, float* g
 
 int tds_util_get_intersect(float x1, float y1, float x2, float y2, struct tds_object* ptr) {
 	float x3, y3, x4, y4;
+	float obj_x = tds_object_get_x(ptr), obj_y = tds_object_get_y(ptr);
+	float obj_w = tds_object_get_cbox_width(ptr), obj_h = tds_object_get_cbox_height(ptr);
 
 	for (int i = 0; i < 4; ++i) {
 		switch(i) {
 		case 0:
-			x3 = -ptr->cbox_width / 2.0f + ptr->x;
-			y3 = -ptr->cbox_height / 2.0f + ptr->y;
-			x4 = ptr->cbox_width / 2.0f + ptr->x;
-			y4 = -ptr->cbox_height / 2.0f + ptr->y;
+			x3 = -obj_w / 2.0f + obj_x;
+			y3 = -obj_h / 2.0f + obj_y;
+			x4 = obj_w / 2.0f + obj_x;
+			y4 = -obj_h / 2.0f + obj_y;
 			break;
 		case 1:
-			x3 = ptr->cbox_width / 2.0f + ptr->x;
-			y3 = -ptr->cbox_height / 2.0f + ptr->y;
-			x4 = ptr->cbox_width / 2.0f + ptr->x;
-			y4 = ptr->cbox_height / 2.0f + ptr->y;
+			x3 = obj_w / 2.0f + obj_x;
+			y3 = -obj_h / 2.0f + obj_y;
+			x4 = obj_w / 2.0f + obj_x;
+			y4 = obj_h / 2.0f + obj_y;
 			break;
 		case 2:
-			x3 = ptr->cbox_width / 2.0f + ptr->x;
-			y3 = ptr->cbox_height / 2.0f + ptr->y;
-			x4 = -ptr->cbox_width / 2.0f + ptr->x;
-			y4 = ptr->cbox_height / 2.0f + ptr->y;
+			x3 = obj_w / 2.0f + obj_x;
+			y3 = obj_h / 2.0f + obj_y;
+			x4 = -obj_w / 2.0f + obj_x;
+			y4 = obj_h / 2.0f + obj_y;
 			break;
 		case 3:
-			x3 = -ptr->cbox_width / 2.0f + ptr->x;
-			y3 = ptr->cbox_height / 2.0f + ptr->y;
-			x4 = -ptr->cbox_width / 2.0f + ptr->x;
-			y4 = -ptr->cbox_height / 2.0f + ptr->y;
+			x3 = -obj_w / 2.0f + obj_x;
+			y3 = obj_h / 2.0f + obj_y;
+			x4 = -obj_w / 2.0f + obj_x;
+			y4 = -obj_h / 2.0f + obj_y;
 			break;
 		}
 
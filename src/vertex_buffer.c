@@ -1,12 +1,21 @@
 #include "vertex_buffer.h"
 #include "log.h"
 #include "memory.h"
+#include "headless.h"
 
 #include <GLXW/glxw.h>
 
 struct tds_vertex_buffer* tds_vertex_buffer_create(struct tds_vertex* verts, int count, unsigned int render_mode) {
 	struct tds_vertex_buffer* output = tds_malloc(sizeof(struct tds_vertex_buffer));
 
+	output->vertex_count = count;
+	output->render_mode = render_mode;
+
+	if (tds_headless) {
+		output->vbo = output->vao = 0;
+		return output;
+	}
+
 	glGenBuffers(1, &output->vbo);
 	glGenVertexArrays(1, &output->vao);
 
@@ -21,13 +30,15 @@ struct tds_vertex_buffer* tds_vertex_buffer_create(struct tds_vertex* verts, int
 	glEnableVertexAttribArray(1); /* texture coordinates */
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(struct tds_vertex), (void*) (sizeof(float) * 3));
 
-	output->vertex_count = count;
-	output->render_mode = render_mode;
-
 	return output;
 }
 
 void tds_vertex_buffer_free(struct tds_vertex_buffer* ptr) {
+	if (!ptr->vao) {
+		tds_free(ptr);
+		return;
+	}
+
 	glBindVertexArray(0);
 	glDeleteVertexArrays(1, &ptr->vao);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -37,5 +48,9 @@ void tds_vertex_buffer_free(struct tds_vertex_buffer* ptr) {
 }
 
 void tds_vertex_buffer_bind(struct tds_vertex_buffer* ptr) {
+	if (!ptr->vao) {
+		return;
+	}
+
 	glBindVertexArray(ptr->vao);
 }
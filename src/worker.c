@@ -0,0 +1,153 @@
+#include "worker.h"
+#include "memory.h"
+#include "log.h"
+
+#include <unistd.h>
+
+static void* _tds_worker_pool_thread(void* pool);
+static void _tds_worker_pool_work(struct tds_worker_pool* ptr);
+
+struct tds_worker_pool* tds_worker_pool_create(int thread_count) {
+	struct tds_worker_pool* output = tds_malloc(sizeof *output);
+
+	if (thread_count < 0) {
+		thread_count = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	}
+
+	if (thread_count < 0) {
+		thread_count = 0;
+	}
+
+	output->thread_count = thread_count;
+	output->threads = thread_count ? tds_malloc(sizeof *output->threads * thread_count) : NULL;
+	output->func = NULL;
+	output->data = NULL;
+	output->count = output->chunk_size = output->next_index = 0;
+	output->busy_workers = output->generation = output->shutdown = 0;
+
+	pthread_mutex_init(&output->lock, NULL);
+	pthread_cond_init(&output->work_cond, NULL);
+	pthread_cond_init(&output->done_cond, NULL);
+
+	for (int i = 0; i < thread_count; ++i) {
+		if (pthread_create(output->threads + i, NULL, _tds_worker_pool_thread, output)) {
+			tds_logf(TDS_LOG_WARNING, "Failed to start worker thread %d, continuing with %d threads.\n", i, i);
+			output->thread_count = i;
+			break;
+		}
+	}
+
+	tds_logf(TDS_LOG_DEBUG, "Started worker pool with %d threads.\n", output->thread_count);
+
+	return output;
+}
+
+void tds_worker_pool_free(struct tds_worker_pool* ptr) {
+	pthread_mutex_lock(&ptr->lock);
+	ptr->shutdown = 1;
+	pthread_cond_broadcast(&ptr->work_cond);
+	pthread_mutex_unlock(&ptr->lock);
+
+	for (int i = 0; i < ptr->thread_count; ++i) {
+		pthread_join(ptr->threads[i], NULL);
+	}
+
+	pthread_cond_destroy(&ptr->work_cond);
+	pthread_cond_destroy(&ptr->done_cond);
+	pthread_mutex_destroy(&ptr->lock);
+
+	tds_free(ptr->threads);
+	tds_free(ptr);
+}
+
+void tds_worker_pool_run(struct tds_worker_pool* ptr, void* data, int count, int chunk_size, void (*func)(void* data, int start, int end)) {
+	if (count <= 0) {
+		return;
+	}
+
+	if (chunk_size <= 0) {
+		chunk_size = 1;
+	}
+
+	if (!ptr->thread_count || count <= chunk_size) {
+		func(data, 0, count);
+		return;
+	}
+
+	pthread_mutex_lock(&ptr->lock);
+
+	ptr->func = func;
+	ptr->data = data;
+	ptr->count = count;
+	ptr->chunk_size = chunk_size;
+	ptr->next_index = 0;
+	ptr->busy_workers = ptr->thread_count;
+	ptr->generation++;
+
+	pthread_cond_broadcast(&ptr->work_cond);
+	pthread_mutex_unlock(&ptr->lock);
+
+	_tds_worker_pool_work(ptr);
+
+	pthread_mutex_lock(&ptr->lock);
+
+	while (ptr->busy_workers) {
+		pthread_cond_wait(&ptr->done_cond, &ptr->lock);
+	}
+
+	ptr->func = NULL;
+	ptr->data = NULL;
+
+	pthread_mutex_unlock(&ptr->lock);
+}
+
+static void* _tds_worker_pool_thread(void* pool) {
+	struct tds_worker_pool* ptr = pool;
+	int generation = 0;
+
+	pthread_mutex_lock(&ptr->lock);
+
+	while (1) {
+		while (!ptr->shutdown && ptr->generation == generation) {
+			pthread_cond_wait(&ptr->work_cond, &ptr->lock);
+		}
+
+		if (ptr->shutdown) {
+			break;
+		}
+
+		generation = ptr->generation;
+		pthread_mutex_unlock(&ptr->lock);
+
+		_tds_worker_pool_work(ptr);
+
+		pthread_mutex_lock(&ptr->lock);
+
+		if (!--ptr->busy_workers) {
+			pthread_cond_signal(&ptr->done_cond);
+		}
+	}
+
+	pthread_mutex_unlock(&ptr->lock);
+	return NULL;
+}
+
+static void _tds_worker_pool_work(struct tds_worker_pool* ptr) {
+	/* Chunks are claimed with an atomic counter, the job fields are only written while every worker is idle. */
+
+	while (1) {
+		int start = __atomic_fetch_add(&ptr->next_index, ptr->chunk_size, __ATOMIC_RELAXED);
+
+		if (start >= ptr->count) {
+			return;
+		}
+
+		int end = start + ptr->chunk_size;
+
+		if (end > ptr->count) {
+			end = ptr->count;
+		}
+
+		ptr->func(ptr->data, start, end);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/* The worker pool runs a parallel-for over an index range.
+ * The calling thread always takes part in the work, so a pool with no worker threads just runs the job inline. */
+
+#include <pthread.h>
+
+struct tds_worker_pool {
+	pthread_t* threads;
+	int thread_count;
+
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond, done_cond;
+
+	void (*func)(void* data, int start, int end);
+	void* data;
+	int count, chunk_size, next_index;
+	int busy_workers, generation, shutdown;
+};
+
+struct tds_worker_pool* tds_worker_pool_create(int thread_count); /* thread_count < 0 will spawn one thread per extra core. */
+void tds_worker_pool_free(struct tds_worker_pool* ptr);
+
+/* Calls func(data, start, end) over [0, count) in chunks of chunk_size and blocks until every chunk is done. */
+void tds_worker_pool_run(struct tds_worker_pool* ptr, void* data, int count, int chunk_size, void (*func)(void* data, int start, int end));
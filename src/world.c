@@ -5,30 +5,60 @@
 
 #include <GLXW/glxw.h>
 #include <string.h>
-
-static void _tds_world_generate_hblocks(struct tds_world* ptr);
-static void _tds_world_generate_segments(struct tds_world* ptr);
+#include <math.h>
+
+static inline uint8_t _tds_world_get(struct tds_world* ptr, int x, int y);
+static const uint8_t* _tds_world_chunk_row(struct tds_world* ptr, int cx, int y);
+static void _tds_world_set(struct tds_world* ptr, int x, int y, uint8_t id);
+static void _tds_world_free_chunks(struct tds_world* ptr);
+static struct tds_world_hblock* _tds_world_extract_row(struct tds_world* ptr, int y, struct tds_world_hblock** tail);
+static void _tds_world_hblock_bounds(struct tds_world* ptr, struct tds_world_hblock* hb, float* l, float* r, float* t, float* b);
+static void _tds_world_hblock_attach(struct tds_world* ptr, struct tds_world_hblock* hb);
+static void _tds_world_hblock_detach(struct tds_world* ptr, struct tds_world_hblock* hb);
+static void _tds_world_regenerate_row(struct tds_world* ptr, int y);
+static void _tds_world_merge_rects(struct tds_world* ptr, int y0, int y1, uint8_t* used);
+static void _tds_world_regenerate_rects(struct tds_world* ptr, const uint8_t* rows);
+static int _tds_world_get_flags(struct tds_world* ptr, int x, int y);
+static int _tds_world_flags_occlude(int flags);
+static int _tds_world_tile_occludes(struct tds_world* ptr, int x, int y);
+static void _tds_world_segment_push(struct tds_world* ptr, float x1, float y1, float x2, float y2, float nx, float ny);
+static void _tds_world_generate_hline(struct tds_world* ptr, int line);
+static void _tds_world_generate_vline(struct tds_world* ptr, int line);
+static void _tds_world_generate_row_slopes(struct tds_world* ptr, int y);
+static int _tds_world_bucket_count(struct tds_world* ptr);
+static void _tds_world_generate_bucket(struct tds_world* ptr, int bucket);
+static void _tds_world_update_segments(struct tds_world* ptr, const uint8_t* dirty);
+static void _tds_world_upload_segments(struct tds_world* ptr);
+static int _tds_world_match_flags(int flags, int flag_req, int flag_or, int flag_not);
+static int _tds_world_tile_range(float lo, float hi, float half, int size, int* t0, int* t1);
+static int _tds_world_overlap(struct tds_world* ptr, float left, float right, float bottom, float top, const int* matches, float* x, float* y, float* w, float* h, int flag_req, int flag_or, int flag_not);
+static int _tds_world_sweep_axis(float box_min, float box_max, float shape_min, float shape_max, float v, float* entry, float* exit);
+static int _tds_world_sweep_tile(struct tds_world* ptr, float left, float right, float bottom, float top, float dx, float dy, int tx, int ty, int flags, struct tds_world_sweep_result* result);
 
 struct tds_world* tds_world_create(void) {
 	struct tds_world* output = tds_malloc(sizeof *output);
 
 	output->width = output->height = 0;
 	output->block_list_head = output->block_list_tail = 0;
-	output->buffer = 0;
-
+	output->hblock_rows = NULL;
+	output->merge_rects = 0;
+	output->chunks = NULL;
+	output->chunk_fill = NULL;
+	output->chunk_width = output->chunk_height = 0;
+	output->occupancy = NULL;
+	output->occupancy_stride = 0;
+
+	output->segments = NULL;
+	output->segment_count = output->segment_capacity = 0;
+	output->segment_buckets = NULL;
+	output->segment_vb = NULL;
 	output->quadtree = NULL;
 
 	return output;
 }
 
 void tds_world_free(struct tds_world* ptr) {
-	if (ptr->buffer) {
-		for (int i = 0; i < ptr->height; ++i) {
-			tds_free(ptr->buffer[i]);
-		}
-
-		tds_free(ptr->buffer);
-	}
+	_tds_world_free_chunks(ptr);
 
 	if (ptr->block_list_head) {
 		struct tds_world_hblock* cur = ptr->block_list_head, *tmp = 0;
@@ -41,12 +71,12 @@ void tds_world_free(struct tds_world* ptr) {
 		}
 	}
 
-	struct tds_world_segment* head = ptr->segment_list, *cur = NULL;
+	if (ptr->segments) {
+		tds_free(ptr->segments);
+	}
 
-	while (head) {
-		cur = head->next;
-		tds_free(head);
-		head = cur;
+	if (ptr->segment_buckets) {
+		tds_free(ptr->segment_buckets);
 	}
 
 	if (ptr->segment_vb) {
@@ -57,30 +87,41 @@ void tds_world_free(struct tds_world* ptr) {
 		tds_quadtree_free(ptr->quadtree);
 	}
 
+	if (ptr->hblock_rows) {
+		tds_free(ptr->hblock_rows);
+	}
+
 	tds_free(ptr);
 }
 
 void tds_world_init(struct tds_world* ptr, int width, int height) {
-	if (ptr->buffer) {
-		for (int i = 0; i < height; ++i) {
-			tds_free(ptr->buffer[i]);
-		}
+	_tds_world_free_chunks(ptr);
 
-		tds_free(ptr->buffer);
-	}
+	ptr->chunk_width = (width + TDS_WORLD_CHUNK_MASK) >> TDS_WORLD_CHUNK_SHIFT;
+	ptr->chunk_height = (height + TDS_WORLD_CHUNK_MASK) >> TDS_WORLD_CHUNK_SHIFT;
 
-	ptr->buffer = tds_malloc(sizeof ptr->buffer[0] * height);
+	ptr->chunks = tds_malloc(sizeof *ptr->chunks * ptr->chunk_width * ptr->chunk_height);
+	ptr->chunk_fill = tds_malloc(sizeof *ptr->chunk_fill * ptr->chunk_width * ptr->chunk_height);
 
-	ptr->width = width;
-	ptr->height = height;
+	memset(ptr->chunks, 0, sizeof *ptr->chunks * ptr->chunk_width * ptr->chunk_height);
+	memset(ptr->chunk_fill, 0, sizeof *ptr->chunk_fill * ptr->chunk_width * ptr->chunk_height);
 
-	for (int y = 0; y < height; ++y) {
-		ptr->buffer[y] = tds_malloc(sizeof ptr->buffer[0][0] * width);
+	ptr->occupancy_stride = (width + 63) >> 6;
+	ptr->occupancy = tds_malloc(sizeof *ptr->occupancy * ptr->occupancy_stride * height);
+	memset(ptr->occupancy, 0, sizeof *ptr->occupancy * ptr->occupancy_stride * height);
 
-		for (int x = 0; x < width; ++x) {
-			ptr->buffer[y][x] = 0;
-		}
+	ptr->hblock_rows = tds_realloc(ptr->hblock_rows, sizeof *ptr->hblock_rows * height);
+
+	for (int y = 0; y < height; ++y) {
+		ptr->hblock_rows[y] = NULL;
 	}
+
+	ptr->width = width;
+	ptr->height = height;
+
+	ptr->segment_count = 0;
+	ptr->segment_buckets = tds_realloc(ptr->segment_buckets, sizeof *ptr->segment_buckets * (_tds_world_bucket_count(ptr) + 1));
+	memset(ptr->segment_buckets, 0, sizeof *ptr->segment_buckets * (_tds_world_bucket_count(ptr) + 1));
 }
 
 void tds_world_load(struct tds_world* ptr, const uint8_t* block_buffer, int width, int height) {
@@ -90,16 +131,18 @@ void tds_world_load(struct tds_world* ptr, const uint8_t* block_buffer, int widt
 
 	for (int y = 0; y < height; ++y) {
 		for (int x = 0; x < width; ++x) {
-			ptr->buffer[y][x] = block_buffer[y * width + x];
+			if (block_buffer[y * width + x]) {
+				_tds_world_set(ptr, x, y, block_buffer[y * width + x]);
+			}
 		}
 	}
 
-	_tds_world_generate_hblocks(ptr);
-	_tds_world_generate_segments(ptr);
+	tds_world_generate_hblocks(ptr);
+	tds_world_generate_segments(ptr);
 }
 
 void tds_world_save(struct tds_world* ptr, uint8_t* block_buffer, int width, int height) {
-	/* Simply copying the buffer. The buffer will _always_ be up to date. */
+	/* Simply copying the chunks. They will _always_ be up to date. */
 
 	if (width != ptr->width || height != ptr->height) {
 		tds_logf(TDS_LOG_CRITICAL, "World size mismatch.\n");
@@ -107,34 +150,82 @@ void tds_world_save(struct tds_world* ptr, uint8_t* block_buffer, int width, int
 	}
 
 	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; ++x) {
-			block_buffer[y * width + x] = ptr->buffer[y][x];
+		for (int cx = 0; cx < ptr->chunk_width; ++cx) {
+			const uint8_t* row = _tds_world_chunk_row(ptr, cx, y);
+			int x = cx << TDS_WORLD_CHUNK_SHIFT, len = (width - x < TDS_WORLD_CHUNK_SIZE) ? width - x : TDS_WORLD_CHUNK_SIZE;
+
+			if (row) {
+				memcpy(block_buffer + y * width + x, row, len);
+			} else {
+				memset(block_buffer + y * width + x, 0, len);
+			}
 		}
 	}
 }
 
 void tds_world_set_block(struct tds_world* ptr, int x, int y, uint8_t block) {
-	if (x >= ptr->width || x < 0 || y >= ptr->height || y < 0) {
-		tds_logf(TDS_LOG_WARNING, "World index out of bounds.\n");
-		return;
+	struct tds_world_block_edit edit = {x, y, block};
+	tds_world_set_blocks(ptr, &edit, 1);
+}
+
+void tds_world_set_blocks(struct tds_world* ptr, const struct tds_world_block_edit* edits, int count) {
+	/* Only the edited rows need new hblocks. The edge segments of a tile live on the horizontal lines above and below it and the vertical lines
+	 * left and right of it, and slopes only depend on the tile itself, so those segment buckets are all that is regenerated. */
+
+	int bucket_count = _tds_world_bucket_count(ptr);
+	int vline_base = ptr->height + 1, slope_base = vline_base + ptr->width + 1;
+	uint8_t* dirty = tds_malloc(bucket_count);
+	int changed = 0;
+
+	memset(dirty, 0, bucket_count);
+
+	for (int i = 0; i < count; ++i) {
+		int x = edits[i].x, y = edits[i].y;
+
+		if (x >= ptr->width || x < 0 || y >= ptr->height || y < 0) {
+			tds_logf(TDS_LOG_WARNING, "World index out of bounds.\n");
+			continue;
+		}
+
+		if (_tds_world_get(ptr, x, y) == edits[i].id) {
+			continue;
+		}
+
+		_tds_world_set(ptr, x, y, edits[i].id);
+
+		dirty[y] = dirty[y + 1] = 1;
+		dirty[vline_base + x] = dirty[vline_base + x + 1] = 1;
+		dirty[slope_base + y] = 1;
+		changed = 1;
 	}
 
-	if (ptr->buffer[y][x] != block) {
-		ptr->buffer[y][x] = block;
+	if (changed) {
+		/* The slope bucket of a row doubles as its hblock dirty flag. */
+		if (ptr->merge_rects) {
+			_tds_world_regenerate_rects(ptr, dirty + slope_base);
+		} else {
+			for (int y = 0; y < ptr->height; ++y) {
+				if (dirty[slope_base + y]) {
+					_tds_world_regenerate_row(ptr, y);
+				}
+			}
+		}
 
-		_tds_world_generate_hblocks(ptr); /* This is not the most efficient way to do this, but it really shouldn't matter with small worlds. */
-		_tds_world_generate_segments(ptr); /* This is the worst. Likely a huge bottleneck. */
+		_tds_world_update_segments(ptr, dirty);
 	}
 
-	/* If worlds end up not being small for some reason, we can regenerate only the block which the target resided in along with it's neighbors. */
-	/* This shouldn't be called often anyway, so.. not a big deal. */
+	tds_free(dirty);
 }
 
 uint8_t tds_world_get_block(struct tds_world* ptr, int x, int y) {
-	return ptr->buffer[y][x];
+	if (x >= ptr->width || x < 0 || y >= ptr->height || y < 0) {
+		return 0;
+	}
+
+	return _tds_world_get(ptr, x, y);
 }
 
-static void _tds_world_generate_hblocks(struct tds_world* ptr) {
+void tds_world_generate_hblocks(struct tds_world* ptr) {
 	/* Perhaps one of the more important functions : regenerate the horizontally reduced blocks */
 
 	if (ptr->block_list_head) {
@@ -151,627 +242,969 @@ static void _tds_world_generate_hblocks(struct tds_world* ptr) {
 		ptr->block_list_head = ptr->block_list_tail = NULL;
 	}
 
+	/* At this time we will also generate VBOs for each hblock, so that tds_render doesn't have to. (and insert the quadtree) */
+
+	if (ptr->quadtree) {
+		tds_quadtree_free(ptr->quadtree);
+	}
+
+	ptr->quadtree = tds_quadtree_create(-(ptr->width + 1.0f) * TDS_WORLD_BLOCK_SIZE / 2.0f, (ptr->width + 1.0f) * TDS_WORLD_BLOCK_SIZE / 2.0f, (ptr->height + 0.5f) * TDS_WORLD_BLOCK_SIZE / 2.0f, -(ptr->height + 1.0f) * TDS_WORLD_BLOCK_SIZE / 2.0f); 
+
+	if (ptr->merge_rects) {
+		uint8_t* used = tds_malloc(ptr->width * ptr->height);
+		memset(used, 0, ptr->width * ptr->height);
+
+		for (int y = 0; y < ptr->height; ++y) {
+			ptr->hblock_rows[y] = NULL;
+		}
+
+		_tds_world_merge_rects(ptr, 0, ptr->height - 1, used);
+		tds_free(used);
+		return;
+	}
+
 	for (int y = 0; y < ptr->height; ++y) {
-		uint8_t cur_type = 0;
-		int block_length = 0, block_x = -1;
-		struct tds_world_hblock* tmp_block = NULL;
+		struct tds_world_hblock* row_tail = NULL, *row_head = _tds_world_extract_row(ptr, y, &row_tail);
 
-		for (int x = 0; x < ptr->width; ++x) {
-			if (ptr->buffer[y][x] != cur_type) {
-				if (block_length > 0 && cur_type) {
-					/* Extract a block. */
-					tmp_block = tds_malloc(sizeof *tmp_block);
-
-					tmp_block->next = 0;
-					tmp_block->x = block_x;
-					tmp_block->y = y;
-					tmp_block->w = block_length;
-					tmp_block->id = cur_type;
-
-					if (ptr->block_list_tail) {
-						ptr->block_list_tail->next = tmp_block;
-					} else {
-						ptr->block_list_head = tmp_block;
-					}
+		ptr->hblock_rows[y] = row_head;
+
+		if (!row_head) {
+			continue;
+		}
+
+		if (ptr->block_list_tail) {
+			ptr->block_list_tail->next = row_head;
+		} else {
+			ptr->block_list_head = row_head;
+		}
+
+		ptr->block_list_tail = row_tail;
+
+		for (struct tds_world_hblock* cur = row_head; cur; cur = cur->next) {
+			_tds_world_hblock_attach(ptr, cur);
+		}
+	}
+}
+
+void tds_world_set_merge_rects(struct tds_world* ptr, int enable) {
+	if (ptr->merge_rects == !!enable) {
+		return;
+	}
+
+	ptr->merge_rects = !!enable;
+
+	if (ptr->hblock_rows) {
+		tds_world_generate_hblocks(ptr);
+	}
+}
+
+int tds_world_get_overlap_fast(struct tds_world* ptr, struct tds_object* obj, float* x, float* y, float* w, float* h, int flag_req, int flag_or, int flag_not) {
+	/* Another important function. Intersection testing with axis-aligned objects. */
+
+	float obj_x = tds_object_get_x(obj), obj_y = tds_object_get_y(obj);
+	float obj_w = tds_object_get_cbox_width(obj), obj_h = tds_object_get_cbox_height(obj);
+
+	if (obj->angle) {
+		tds_logf(TDS_LOG_WARNING, "The target object is not axis-aligned. Using a wider bounding box than normal to accommadate.\n");
+
+		float diagonal = sqrtf(pow(obj_w, 2) + pow(obj_h, 2)) / 2.0f;
+
+		return _tds_world_overlap(ptr, obj_x - diagonal, obj_x + diagonal, obj_y - diagonal, obj_y + diagonal, NULL, x, y, w, h, flag_req, flag_or, flag_not);
+	}
+
+	return _tds_world_overlap(ptr, obj_x - obj_w / 2.0f, obj_x + obj_w / 2.0f, obj_y - obj_h / 2.0f, obj_y + obj_h / 2.0f, NULL, x, y, w, h, flag_req, flag_or, flag_not);
+}
+
+int tds_world_get_overlap_box(struct tds_world* ptr, float x, float y, float w, float h, float* hit_x, float* hit_y, float* hit_w, float* hit_h, int flag_req, int flag_or, int flag_not) {
+	return _tds_world_overlap(ptr, x - w / 2.0f, x + w / 2.0f, y - h / 2.0f, y + h / 2.0f, NULL, hit_x, hit_y, hit_w, hit_h, flag_req, flag_or, flag_not);
+}
 
-					ptr->block_list_tail = tmp_block;
+int tds_world_get_overlap_batch(struct tds_world* ptr, struct tds_world_overlap_query* queries, int count, int flag_req, int flag_or, int flag_not) {
+	/* The filter is resolved for every block id once up front, so the queries themselves never touch the block map. */
+
+	int matches[256], hits = 0;
+
+	for (int i = 0; i < 256; ++i) {
+		matches[i] = _tds_world_match_flags(tds_block_map_get(tds_engine_global->block_map_handle, i).flags, flag_req, flag_or, flag_not);
+	}
+
+	for (int i = 0; i < count; ++i) {
+		struct tds_world_overlap_query* cur = queries + i;
+
+		cur->flags = _tds_world_overlap(ptr, cur->x - cur->w / 2.0f, cur->x + cur->w / 2.0f, cur->y - cur->h / 2.0f, cur->y + cur->h / 2.0f, matches, &cur->hit_x, &cur->hit_y, &cur->hit_w, &cur->hit_h, flag_req, flag_or, flag_not);
+		hits += cur->flags != 0;
+	}
+
+	return hits;
+}
+
+int tds_world_sweep(struct tds_world* ptr, float x, float y, float w, float h, float dx, float dy, int flag_req, int flag_or, int flag_not, struct tds_world_sweep_result* result) {
+	/* Rows are visited in the order the box reaches them, and each row only over the columns the box covers while it is inside that row.
+	 * Once a row is entered later than the best contact so far, nothing further along can be hit first. */
+
+	struct tds_world_sweep_result best = {1.0f, 0.0f, 0.0f, 0, 0, -1, -1};
+	float left = x - w / 2.0f, right = x + w / 2.0f, bottom = y - h / 2.0f, top = y + h / 2.0f;
+	float half_w = ptr->width / 2.0f, half_h = ptr->height / 2.0f;
+	int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+
+	if (ptr->occupancy && _tds_world_tile_range(fminf(bottom, bottom + dy), fmaxf(top, top + dy), half_h, ptr->height, &y0, &y1)) {
+		int step = (dy < 0.0f) ? -1 : 1;
+
+		for (int ty = (step > 0) ? y0 : y1; ty >= y0 && ty <= y1; ty += step) {
+			float row_bottom = (ty - half_h) * TDS_WORLD_BLOCK_SIZE;
+			float row_top = (ty + 1.0f - half_h) * TDS_WORLD_BLOCK_SIZE;
+			float t_in = 0.0f, t_out = 1.0f;
+
+			/* The part of the motion during which the box spans this row. */
+			if (dy > 0.0f) {
+				t_in = fmaxf(t_in, (row_bottom - top) / dy);
+				t_out = fminf(t_out, (row_top - bottom) / dy);
+			} else if (dy < 0.0f) {
+				t_in = fmaxf(t_in, (row_top - bottom) / dy);
+				t_out = fminf(t_out, (row_bottom - top) / dy);
+			} else if (top < row_bottom || bottom > row_top) {
+				continue;
+			}
+
+			if (t_in > best.t) {
+				break;
+			}
+
+			if (t_in > t_out) {
+				continue;
+			}
+
+			float row_left = fminf(left + dx * t_in, left + dx * t_out), row_right = fmaxf(right + dx * t_in, right + dx * t_out);
+
+			if (!_tds_world_tile_range(row_left, row_right, half_w, ptr->width, &x0, &x1)) {
+				continue;
+			}
+
+			const uint64_t* bits = ptr->occupancy + ty * ptr->occupancy_stride;
+
+			for (int word = x0 >> 6; word <= x1 >> 6; ++word) {
+				uint64_t mask = bits[word];
+
+				if (word == x0 >> 6) {
+					mask &= ~0ULL << (x0 & 63);
 				}
 
-				cur_type = ptr->buffer[y][x];
-				block_x = x;
-				block_length = 1;
-			} else {
-				block_length++;
+				if (word == x1 >> 6) {
+					mask &= ~0ULL >> (63 - (x1 & 63));
+				}
+
+				while (mask) {
+					int tx = (word << 6) | __builtin_ctzll(mask);
+					mask &= mask - 1;
+
+					int flags = _tds_world_match_flags(tds_block_map_get(tds_engine_global->block_map_handle, _tds_world_get(ptr, tx, ty)).flags, flag_req, flag_or, flag_not);
+
+					if (flags) {
+						_tds_world_sweep_tile(ptr, left, right, bottom, top, dx, dy, tx, ty, flags, &best);
+					}
+				}
+			}
+		}
+	}
+
+	if (result) {
+		*result = best;
+	}
+
+	return best.flags != 0;
+}
+
+void tds_world_generate_segments(struct tds_world* ptr) {
+	/* Every bucket is one edge line (or the slopes of one row), swept in tile order. Adjacent edges are merged as they are found,
+	 * so the whole pass is linear in the number of tiles and the segments come out already grouped by bucket. */
+
+	int bucket_count = _tds_world_bucket_count(ptr);
+
+	ptr->segment_count = 0;
+
+	for (int bucket = 0; bucket < bucket_count; ++bucket) {
+		ptr->segment_buckets[bucket] = ptr->segment_count;
+		_tds_world_generate_bucket(ptr, bucket);
+	}
+
+	ptr->segment_buckets[bucket_count] = ptr->segment_count;
+
+	tds_logf(TDS_LOG_DEBUG, "Generated %d segments in %d buckets.\n", ptr->segment_count, bucket_count);
+
+	_tds_world_upload_segments(ptr);
+}
+
+static struct tds_world_hblock* _tds_world_extract_row(struct tds_world* ptr, int y, struct tds_world_hblock** tail) {
+	/* Splits one row into runs of identical blocks. The list is returned without vertex buffers, see _tds_world_hblock_attach. */
+
+	struct tds_world_hblock* head = NULL;
+	const uint8_t* row = NULL;
+	uint8_t cur_type = 0;
+	int block_length = 0, block_x = -1;
+
+	*tail = NULL;
+
+	/* One step past the end of the row reads as air, so the last run is extracted in the loop. */
+	for (int x = 0; x <= ptr->width; ++x) {
+		uint8_t id = 0;
+
+		if (x < ptr->width) {
+			if (!(x & TDS_WORLD_CHUNK_MASK)) {
+				row = _tds_world_chunk_row(ptr, x >> TDS_WORLD_CHUNK_SHIFT, y);
 			}
+
+			id = row ? row[x & TDS_WORLD_CHUNK_MASK] : 0;
 		}
 
-		if (!cur_type) {
-			continue; /* The last block is air, no reason to generate it */
+		if (id == cur_type) {
+			block_length++;
+			continue;
 		}
 
-		/* We also extract a block afterwards, or we'll miss some */
-		/* Extract a block. */
-		tmp_block = tds_malloc(sizeof *tmp_block);
+		if (block_length > 0 && cur_type) {
+			/* Extract a block. */
+			struct tds_world_hblock* tmp_block = tds_malloc(sizeof *tmp_block);
 
-		tmp_block->next = 0;
-		tmp_block->x = block_x;
-		tmp_block->y = y;
-		tmp_block->w = block_length;
-		tmp_block->id = cur_type;
+			tmp_block->next = 0;
+			tmp_block->x = block_x;
+			tmp_block->y = y;
+			tmp_block->w = block_length;
+			tmp_block->h = 1;
+			tmp_block->id = cur_type;
+			tmp_block->vb = NULL;
 
-		if (ptr->block_list_tail) {
-			ptr->block_list_tail->next = tmp_block;
-		} else {
-			ptr->block_list_head = tmp_block;
+			if (*tail) {
+				(*tail)->next = tmp_block;
+			} else {
+				head = tmp_block;
+			}
+
+			*tail = tmp_block;
 		}
 
-		ptr->block_list_tail = tmp_block;
+		cur_type = id;
+		block_x = x;
+		block_length = 1;
 	}
 
-	/* At this time we will also generate VBOs for each hblock, so that tds_render doesn't have to. (and insert the quadtree) */
+	return head;
+}
 
-	if (ptr->quadtree) {
-		tds_quadtree_free(ptr->quadtree);
+static void _tds_world_hblock_bounds(struct tds_world* ptr, struct tds_world_hblock* hb, float* l, float* r, float* t, float* b) {
+	float render_x = TDS_WORLD_BLOCK_SIZE * (hb->x - ptr->width / 2.0f + (hb->w) / 2.0f);
+	float render_y = TDS_WORLD_BLOCK_SIZE * (hb->y - ptr->height / 2.0f + (hb->h) / 2.0f);
+
+	*l = render_x - hb->w / 2.0f * TDS_WORLD_BLOCK_SIZE;
+	*r = render_x + hb->w / 2.0f * TDS_WORLD_BLOCK_SIZE;
+	*t = render_y + hb->h / 2.0f * TDS_WORLD_BLOCK_SIZE;
+	*b = render_y - hb->h / 2.0f * TDS_WORLD_BLOCK_SIZE;
+}
+
+static void _tds_world_hblock_attach(struct tds_world* ptr, struct tds_world_hblock* hb) {
+	/* Texcoords count tiles, the block texture repeats once per tile. */
+	struct tds_vertex vert_list[] = {
+		{ -hb->w * TDS_WORLD_BLOCK_SIZE / 2.0f, hb->h * TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, 0.0f, hb->h },
+		{ hb->w * TDS_WORLD_BLOCK_SIZE / 2.0f, -hb->h * TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, hb->w, 0.0f },
+		{ hb->w * TDS_WORLD_BLOCK_SIZE / 2.0f, hb->h * TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, hb->w, hb->h },
+		{ -hb->w * TDS_WORLD_BLOCK_SIZE / 2.0f, hb->h * TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, 0.0f, hb->h },
+		{ hb->w * TDS_WORLD_BLOCK_SIZE / 2.0f, -hb->h * TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, hb->w, 0.0f },
+		{ -hb->w * TDS_WORLD_BLOCK_SIZE / 2.0f, -hb->h * TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, 0.0f, 0.0f },
+	};
+
+	float block_left, block_right, block_top, block_bottom;
+	_tds_world_hblock_bounds(ptr, hb, &block_left, &block_right, &block_top, &block_bottom);
+
+	tds_quadtree_insert(ptr->quadtree, block_left, block_right, block_top, block_bottom, hb);
+
+	hb->vb = tds_vertex_buffer_create(vert_list, 6, GL_TRIANGLES);
+}
+
+static void _tds_world_hblock_detach(struct tds_world* ptr, struct tds_world_hblock* hb) {
+	float block_left, block_right, block_top, block_bottom;
+	_tds_world_hblock_bounds(ptr, hb, &block_left, &block_right, &block_top, &block_bottom);
+
+	if (!tds_quadtree_remove(ptr->quadtree, block_left, block_right, block_top, block_bottom, hb)) {
+		tds_logf(TDS_LOG_WARNING, "hblock at %d, %d was not in the world quadtree.\n", hb->x, hb->y);
 	}
 
-	ptr->quadtree = tds_quadtree_create(-(ptr->width + 1.0f) * TDS_WORLD_BLOCK_SIZE / 2.0f, (ptr->width + 1.0f) * TDS_WORLD_BLOCK_SIZE / 2.0f, (ptr->height + 0.5f) * TDS_WORLD_BLOCK_SIZE / 2.0f, -(ptr->height + 1.0f) * TDS_WORLD_BLOCK_SIZE / 2.0f); 
+	tds_vertex_buffer_free(hb->vb);
+	tds_free(hb);
+}
 
-	struct tds_world_hblock* hb_cur = ptr->block_list_head;
-	while (hb_cur) {
-		struct tds_vertex vert_list[] = {
-			{ -hb_cur->w * TDS_WORLD_BLOCK_SIZE / 2.0f, TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, 0.0f, 1.0f },
-			{ hb_cur->w * TDS_WORLD_BLOCK_SIZE / 2.0f, -TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, hb_cur->w, 0.0f },
-			{ hb_cur->w * TDS_WORLD_BLOCK_SIZE / 2.0f, TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, hb_cur->w, 1.0f },
-			{ -hb_cur->w * TDS_WORLD_BLOCK_SIZE / 2.0f, TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, 0.0f, 1.0f },
-			{ hb_cur->w * TDS_WORLD_BLOCK_SIZE / 2.0f, -TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, hb_cur->w, 0.0f },
-			{ -hb_cur->w * TDS_WORLD_BLOCK_SIZE / 2.0f, -TDS_WORLD_BLOCK_SIZE / 2.0f, 0.0f, 0.0f, 0.0f },
-		};
+static void _tds_world_regenerate_row(struct tds_world* ptr, int y) {
+	/* The block list is ordered by row. Find the last hblock of the closest non-empty row below this one, which is where the row is spliced in. */
 
-		float render_x = TDS_WORLD_BLOCK_SIZE * (hb_cur->x - ptr->width / 2.0f + (hb_cur->w) / 2.0f);
-		float render_y = TDS_WORLD_BLOCK_SIZE * (hb_cur->y - ptr->height / 2.0f + 0.5f);
+	struct tds_world_hblock* prev = NULL;
 
-		float block_left = render_x - hb_cur->w / 2.0f * TDS_WORLD_BLOCK_SIZE;
-		float block_right = render_x + hb_cur->w / 2.0f * TDS_WORLD_BLOCK_SIZE;
-		float block_top = render_y + TDS_WORLD_BLOCK_SIZE / 2.0f;
-		float block_bottom = render_y - TDS_WORLD_BLOCK_SIZE / 2.0f;
+	for (int k = y - 1; k >= 0 && !prev; --k) {
+		prev = ptr->hblock_rows[k];
+	}
+
+	while (prev && prev->next && prev->next->y < y) {
+		prev = prev->next;
+	}
+
+	struct tds_world_hblock* after = prev ? prev->next : ptr->block_list_head;
+
+	while (after && after->y == y) {
+		struct tds_world_hblock* tmp = after->next;
+		_tds_world_hblock_detach(ptr, after);
+		after = tmp;
+	}
 
-		tds_quadtree_insert(ptr->quadtree, block_left, block_right, block_top, block_bottom, hb_cur);
+	struct tds_world_hblock* row_tail = NULL, *row_head = _tds_world_extract_row(ptr, y, &row_tail);
 
-		hb_cur->vb = tds_vertex_buffer_create(vert_list, 6, GL_TRIANGLES);
+	for (struct tds_world_hblock* cur = row_head; cur; cur = cur->next) {
+		_tds_world_hblock_attach(ptr, cur);
+	}
+
+	ptr->hblock_rows[y] = row_head;
+
+	if (row_head) {
+		row_tail->next = after;
+	} else {
+		row_head = after;
+		row_tail = prev;
+	}
+
+	if (prev) {
+		prev->next = row_head;
+	} else {
+		ptr->block_list_head = row_head;
+	}
 
-		hb_cur = hb_cur->next;
+	if (!after) {
+		ptr->block_list_tail = row_tail;
 	}
 }
 
-int tds_world_get_overlap_fast(struct tds_world* ptr, struct tds_object* obj, float* x, float* y, float* w, float* h, int flag_req, int flag_or, int flag_not) {
-	/* Another important function. Intersection testing with axis-aligned objects. */
+static void _tds_world_merge_rects(struct tds_world* ptr, int y0, int y1, uint8_t* used) {
+	/* Greedy rectangle cover of rows y0..y1 : from each uncovered tile, grow right over identical tiles, then grow up while the row above holds
+	 * exactly the same run. Only taking whole runs means a rectangle never splits a wider run above it, so there are never more rectangles than runs.
+	 * used is a (y1 - y0 + 1) by width mask of tiles that are already covered, it is filled in as rectangles are emitted.
+	 * New hblocks are attached and appended to the block list. */
 
-	float obj_left = obj->x - obj->cbox_width / 2.0f;
-	float obj_right = obj->x + obj->cbox_width / 2.0f;
-	float obj_bottom = obj->y - obj->cbox_height / 2.0f;
-	float obj_top = obj->y + obj->cbox_height / 2.0f;
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = 0; x < ptr->width; ++x) {
+			uint8_t id = _tds_world_get(ptr, x, y);
 
-	if (obj->angle) {
-		tds_logf(TDS_LOG_WARNING, "The target object is not axis-aligned. Using a wider bounding box than normal to accommadate.\n");
+			if (!id || used[(y - y0) * ptr->width + x]) {
+				continue;
+			}
+
+			int w = 1, h = 1;
+
+			while (x + w < ptr->width && !used[(y - y0) * ptr->width + x + w] && _tds_world_get(ptr, x + w, y) == id) {
+				++w;
+			}
+
+			for (int grow = 1; grow && y + h <= y1; ) {
+				const uint8_t* above = used + (y + h - y0) * ptr->width;
+
+				for (int i = x - 1; i <= x + w; ++i) {
+					int inside = (i >= x && i < x + w), same = (i >= 0 && i < ptr->width && !above[i] && _tds_world_get(ptr, i, y + h) == id);
 
-		float diagonal = sqrtf(pow(obj->cbox_width, 2) + pow(obj->cbox_height, 2)) / 2.0f;
+					if (inside != same) {
+						grow = 0;
+						break;
+					}
+				}
+
+				h += grow;
+			}
+
+			for (int j = y; j < y + h; ++j) {
+				memset(used + (j - y0) * ptr->width + x, 1, w);
+			}
+
+			struct tds_world_hblock* hb = tds_malloc(sizeof *hb);
 
-		obj_left = obj->x - diagonal;
-		obj_right = obj->x + diagonal;
-		obj_bottom = obj->y - diagonal;
-		obj_top = obj->y + diagonal;
+			hb->next = NULL;
+			hb->x = x;
+			hb->y = y;
+			hb->w = w;
+			hb->h = h;
+			hb->id = id;
+
+			_tds_world_hblock_attach(ptr, hb);
+
+			if (ptr->block_list_tail) {
+				ptr->block_list_tail->next = hb;
+			} else {
+				ptr->block_list_head = hb;
+			}
+
+			ptr->block_list_tail = hb;
+		}
 	}
+}
 
-	/* The world block coordinates will be treated as centers. The block at [0, 0] will be centered on the origin. */
-	struct tds_world_hblock* cblock = ptr->block_list_head;
+static void _tds_world_regenerate_rects(struct tds_world* ptr, const uint8_t* rows) {
+	/* Merged rectangles can span many rows. Every rectangle touching an edited row is dropped, and the rows they covered are merged again,
+	 * around the rectangles that are left. The result can be a little less compact than a full regeneration, but it is always an exact cover. */
 
-	while (cblock) {
-		float cblock_left = (cblock->x - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-		float cblock_right = (cblock->x + cblock->w - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-		float cblock_top = (cblock->y + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-		float cblock_bottom = (cblock->y - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+	int y0 = ptr->height, y1 = -1;
 
-		if (obj_left > cblock_right) {
-			cblock = cblock->next;
-			continue;
+	for (int y = 0; y < ptr->height; ++y) {
+		if (rows[y]) {
+			y0 = (y < y0) ? y : y0;
+			y1 = y;
 		}
+	}
 
-		if (obj_right < cblock_left) {
-			cblock = cblock->next;
-			continue;
+	struct tds_world_hblock** link = &ptr->block_list_head;
+	ptr->block_list_tail = NULL;
+
+	while (*link) {
+		struct tds_world_hblock* cur = *link;
+		int touched = 0;
+
+		for (int y = cur->y; y < cur->y + cur->h && !touched; ++y) {
+			touched = rows[y];
 		}
 
-		if (obj_top < cblock_bottom) {
-			cblock = cblock->next;
+		if (!touched) {
+			ptr->block_list_tail = cur;
+			link = &cur->next;
 			continue;
 		}
 
-		if (obj_bottom > cblock_top) {
-			cblock = cblock->next;
-			continue;
+		y0 = (cur->y < y0) ? cur->y : y0;
+		y1 = (cur->y + cur->h - 1 > y1) ? cur->y + cur->h - 1 : y1;
+
+		*link = cur->next;
+		_tds_world_hblock_detach(ptr, cur);
+	}
+
+	if (y1 < y0) {
+		return;
+	}
+
+	uint8_t* used = tds_malloc((y1 - y0 + 1) * ptr->width);
+	memset(used, 0, (y1 - y0 + 1) * ptr->width);
+
+	for (struct tds_world_hblock* cur = ptr->block_list_head; cur; cur = cur->next) {
+		for (int y = cur->y; y < cur->y + cur->h; ++y) {
+			if (y >= y0 && y <= y1) {
+				memset(used + (y - y0) * ptr->width + cur->x, 1, cur->w);
+			}
 		}
+	}
+
+	_tds_world_merge_rects(ptr, y0, y1, used);
+	tds_free(used);
+}
 
-		int flags = tds_block_map_get(tds_engine_global->block_map_handle, cblock->id).flags;
+static int _tds_world_get_flags(struct tds_world* ptr, int x, int y) {
+	if (x < 0 || x >= ptr->width || y < 0 || y >= ptr->height) {
+		return 0;
+	}
 
-		if ((flags & flag_req) != flag_req) {
-			cblock = cblock->next;
-			continue;
+	return tds_block_map_get(tds_engine_global->block_map_handle, _tds_world_get(ptr, x, y)).flags;
+}
+
+static int _tds_world_flags_occlude(int flags) {
+	/* Solid, lit blocks cast shadows. */
+	return (flags & TDS_BLOCK_TYPE_SOLID) && !(flags & TDS_BLOCK_TYPE_NOLIGHT);
+}
+
+static int _tds_world_tile_occludes(struct tds_world* ptr, int x, int y) {
+	/* Air never casts edges of its own, whatever the block map says about id 0. */
+	if (x < 0 || x >= ptr->width || y < 0 || y >= ptr->height || !_tds_world_get(ptr, x, y)) {
+		return 0;
+	}
+
+	return _tds_world_flags_occlude(_tds_world_get_flags(ptr, x, y));
+}
+
+static void _tds_world_segment_push(struct tds_world* ptr, float x1, float y1, float x2, float y2, float nx, float ny) {
+	if (ptr->segment_count >= ptr->segment_capacity) {
+		ptr->segment_capacity = ptr->segment_capacity ? ptr->segment_capacity * 2 : 256;
+		ptr->segments = tds_realloc(ptr->segments, sizeof *ptr->segments * ptr->segment_capacity);
+	}
+
+	struct tds_world_segment* cur = ptr->segments + ptr->segment_count++;
+
+	cur->x1 = x1;
+	cur->y1 = y1;
+	cur->x2 = x2;
+	cur->y2 = y2;
+	cur->nx = nx;
+	cur->ny = ny;
+}
+
+static void _tds_world_generate_hline(struct tds_world* ptr, int line) {
+	/* Horizontal line [line] is the top of row line - 1 and the bottom of row line. Adjacent edges are merged as they are found,
+	 * so every segment is a maximal run of edges with the same facing. */
+
+	int run = -1;
+
+	for (int x = 0; x <= ptr->width; ++x) {
+		int flags = _tds_world_get_flags(ptr, x, line - 1);
+		int edge = x < ptr->width && _tds_world_tile_occludes(ptr, x, line - 1) && !_tds_world_flags_occlude(_tds_world_get_flags(ptr, x, line)) && !(flags & (TDS_BLOCK_TYPE_LTSLOPE | TDS_BLOCK_TYPE_RTSLOPE));
+
+		if (edge && run < 0) {
+			run = x;
+		} else if (!edge && run >= 0) {
+			/* Out-facing up segment. */
+			float block_top = (line - 1 + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+			_tds_world_segment_push(ptr, (x - 1 + 1.0f - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE, block_top, (run - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE, block_top, 0.0f, 1.0f);
+			run = -1;
 		}
+	}
 
-		if (!(flags & flag_or)) {
-			cblock = cblock->next;
-			continue;
+	for (int x = 0; x <= ptr->width; ++x) {
+		int flags = _tds_world_get_flags(ptr, x, line);
+		int edge = x < ptr->width && _tds_world_tile_occludes(ptr, x, line) && !_tds_world_flags_occlude(_tds_world_get_flags(ptr, x, line - 1)) && !(flags & (TDS_BLOCK_TYPE_LBSLOPE | TDS_BLOCK_TYPE_RBSLOPE));
+
+		if (edge && run < 0) {
+			run = x;
+		} else if (!edge && run >= 0) {
+			/* Out-facing down segment. */
+			float block_bottom = (line - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+			_tds_world_segment_push(ptr, (run - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE, block_bottom, (x - 1 + 1.0f - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE, block_bottom, 0.0f, -1.0f);
+			run = -1;
 		}
+	}
+}
+
+static void _tds_world_generate_vline(struct tds_world* ptr, int line) {
+	/* Vertical line [line] is the right side of column line - 1 and the left side of column line. */
+
+	int run = -1;
 
-		if (flags & flag_not) {
-			cblock = cblock->next;
+	for (int y = 0; y <= ptr->height; ++y) {
+		int flags = _tds_world_get_flags(ptr, line - 1, y);
+		int edge = y < ptr->height && _tds_world_tile_occludes(ptr, line - 1, y) && !_tds_world_flags_occlude(_tds_world_get_flags(ptr, line, y)) && !(flags & (TDS_BLOCK_TYPE_RTSLOPE | TDS_BLOCK_TYPE_RBSLOPE));
+
+		if (edge && run < 0) {
+			run = y;
+		} else if (!edge && run >= 0) {
+			/* Out-facing right segment. */
+			float block_right = (line - 1 + 1.0f - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+			_tds_world_segment_push(ptr, block_right, (run - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE, block_right, (y - 1 + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE, 1.0f, 0.0f);
+			run = -1;
+		}
+	}
+
+	for (int y = 0; y <= ptr->height; ++y) {
+		int flags = _tds_world_get_flags(ptr, line, y);
+		int edge = y < ptr->height && _tds_world_tile_occludes(ptr, line, y) && !_tds_world_flags_occlude(_tds_world_get_flags(ptr, line - 1, y)) && !(flags & (TDS_BLOCK_TYPE_LTSLOPE | TDS_BLOCK_TYPE_LBSLOPE));
+
+		if (edge && run < 0) {
+			run = y;
+		} else if (!edge && run >= 0) {
+			/* Out-facing left segment. */
+			float block_left = (line - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+			_tds_world_segment_push(ptr, block_left, (y - 1 + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE, block_left, (run - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE, -1.0f, 0.0f);
+			run = -1;
+		}
+	}
+}
+
+static void _tds_world_generate_row_slopes(struct tds_world* ptr, int y) {
+	float block_top = (y + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+	float block_bottom = (y - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+
+	for (int x = 0; x < ptr->width; ++x) {
+		if (!_tds_world_tile_occludes(ptr, x, y)) {
 			continue;
 		}
 
-		if (x) {
-			*x = (cblock_left + cblock_right) / 2.0f;
+		int flags = _tds_world_get_flags(ptr, x, y);
+		float block_left = (x  - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+		float block_right = (x + 1.0f - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+
+		if (flags & TDS_BLOCK_TYPE_LTSLOPE) {
+			_tds_world_segment_push(ptr, block_left, block_bottom, block_right, block_top, -1.0f, 1.0f);
 		}
 
-		if (y) {
-			*y = (cblock_top + cblock_bottom) / 2.0f;
+		if (flags & TDS_BLOCK_TYPE_RTSLOPE) {
+			_tds_world_segment_push(ptr, block_right, block_bottom, block_left, block_top, 1.0f, 1.0f);
 		}
 
-		if (w) {
-			*w = cblock_right - cblock_left;
+		if (flags & TDS_BLOCK_TYPE_RBSLOPE) {
+			_tds_world_segment_push(ptr, block_left, block_bottom, block_right, block_top, 1.0f, -1.0f);
 		}
 
-		if (h) {
-			*h = cblock_top - cblock_bottom;
+		if (flags & TDS_BLOCK_TYPE_LBSLOPE) {
+			_tds_world_segment_push(ptr, block_left, block_top, block_right, block_bottom, -1.0f, -1.0f);
 		}
+	}
+}
+
+static int _tds_world_bucket_count(struct tds_world* ptr) {
+	return (ptr->height + 1) + (ptr->width + 1) + ptr->height;
+}
 
-		return flags;
+static void _tds_world_generate_bucket(struct tds_world* ptr, int bucket) {
+	if (bucket <= ptr->height) {
+		_tds_world_generate_hline(ptr, bucket);
+		return;
 	}
 
-	return 0;
+	bucket -= ptr->height + 1;
+
+	if (bucket <= ptr->width) {
+		_tds_world_generate_vline(ptr, bucket);
+		return;
+	}
+
+	_tds_world_generate_row_slopes(ptr, bucket - (ptr->width + 1));
 }
 
-void _tds_world_generate_segments(struct tds_world* ptr) {
-	struct tds_world_segment* head = ptr->segment_list, *cur = NULL;
+static void _tds_world_update_segments(struct tds_world* ptr, const uint8_t* dirty) {
+	/* Rebuild the segment array bucket by bucket : clean buckets are copied over from the old array, dirty ones are regenerated. */
+
+	int bucket_count = _tds_world_bucket_count(ptr);
+	struct tds_world_segment* old_segments = ptr->segments;
+
+	ptr->segments = tds_malloc(sizeof *ptr->segments * ptr->segment_capacity);
+	ptr->segment_count = 0;
+
+	for (int bucket = 0; bucket < bucket_count; ++bucket) {
+		int old_start = ptr->segment_buckets[bucket], old_end = ptr->segment_buckets[bucket + 1];
+
+		ptr->segment_buckets[bucket] = ptr->segment_count;
+
+		if (dirty[bucket]) {
+			_tds_world_generate_bucket(ptr, bucket);
+			continue;
+		}
+
+		for (int i = old_start; i < old_end; ++i) {
+			_tds_world_segment_push(ptr, old_segments[i].x1, old_segments[i].y1, old_segments[i].x2, old_segments[i].y2, old_segments[i].nx, old_segments[i].ny);
+		}
+	}
+
+	ptr->segment_buckets[bucket_count] = ptr->segment_count;
 
-	while (head) {
-		cur = head->next;
-		tds_free(head);
-		head = cur;
+	if (old_segments) {
+		tds_free(old_segments);
 	}
 
+	_tds_world_upload_segments(ptr);
+}
+
+static void _tds_world_upload_segments(struct tds_world* ptr) {
 	if (ptr->segment_vb) {
 		tds_vertex_buffer_free(ptr->segment_vb);
 	}
 
-	ptr->segment_list = NULL;
-	ptr->segment_vb = NULL;
+	struct tds_vertex* segment_verts = tds_malloc(ptr->segment_count * sizeof(struct tds_vertex) * 2);
 
-	tds_logf(TDS_LOG_DEBUG, "Starting redundant segment generation phase.\n");
+	for (int i = 0; i < ptr->segment_count; ++i) {
+		struct tds_world_segment* cur = ptr->segments + i;
 
-	/* We start by generating a large list of segments without any reduction. */
-	for (int x = 0; x < ptr->width; ++x) {
-		for (int y = 0; y < ptr->height; ++y) {
-			/* For each index, we only consider out-facing edges at the current location. */
-			if (!ptr->buffer[y][x]) {
-				continue;
-			}
+		struct tds_vertex verts[] = {
+			{cur->x1, cur->y1, 0.0f, cur->nx, cur->ny}, /* We hide the normal in the texcoords, saving some time. */
+			{cur->x2, cur->y2, 0.0f, cur->nx, cur->ny},
+		};
 
-			int flags = tds_block_map_get(tds_engine_global->block_map_handle, ptr->buffer[y][x]).flags;
+		segment_verts[2 * i] = verts[0];
+		segment_verts[2 * i + 1] = verts[1];
+	}
 
-			if (flags & TDS_BLOCK_TYPE_NOLIGHT || !(flags & TDS_BLOCK_TYPE_SOLID)) {
-				continue;
-			}
+	ptr->segment_vb = tds_vertex_buffer_create(segment_verts, ptr->segment_count * 2, GL_LINES);
+	tds_free(segment_verts);
+}
 
-			float block_left = (x  - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-			float block_right = (x + 1.0f - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-			float block_top = (y + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-			float block_bottom = (y - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
-
-			int flags_right = (x < ptr->width - 1) ? tds_block_map_get(tds_engine_global->block_map_handle, ptr->buffer[y][x + 1]).flags : 0;
-			int flags_left = (x > 0) ? tds_block_map_get(tds_engine_global->block_map_handle, ptr->buffer[y][x - 1]).flags : 0;
-			int flags_top = (y < ptr->height - 1) ? tds_block_map_get(tds_engine_global->block_map_handle, ptr->buffer[y + 1][x]).flags : 0;
-			int flags_bottom = (y > 0) ? tds_block_map_get(tds_engine_global->block_map_handle, ptr->buffer[y - 1][x]).flags : 0;
-
-			if ((flags_right & TDS_BLOCK_TYPE_NOLIGHT || !(flags_right & TDS_BLOCK_TYPE_SOLID)) && !(flags & (TDS_BLOCK_TYPE_RTSLOPE | TDS_BLOCK_TYPE_RBSLOPE))) {
-				/* Out-facing right segment. */
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_right;
-				cur->y1 = block_bottom;
-				cur->x2 = block_right;
-				cur->y2 = block_top;
-				cur->nx = 1.0f;
-				cur->ny = 0.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+static inline uint8_t _tds_world_get(struct tds_world* ptr, int x, int y) {
+	const uint8_t* chunk = ptr->chunks[(y >> TDS_WORLD_CHUNK_SHIFT) * ptr->chunk_width + (x >> TDS_WORLD_CHUNK_SHIFT)];
+	return chunk ? chunk[((y & TDS_WORLD_CHUNK_MASK) << TDS_WORLD_CHUNK_SHIFT) | (x & TDS_WORLD_CHUNK_MASK)] : 0;
+}
 
-			if ((flags_left & TDS_BLOCK_TYPE_NOLIGHT || !(flags_left & TDS_BLOCK_TYPE_SOLID)) && !(flags & (TDS_BLOCK_TYPE_LTSLOPE | TDS_BLOCK_TYPE_LBSLOPE))) {
-				/* Out-facing left segment. */
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_left;
-				cur->y1 = block_top;
-				cur->x2 = block_left;
-				cur->y2 = block_bottom;
-				cur->nx = -1.0f;
-				cur->ny = 0.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+static const uint8_t* _tds_world_chunk_row(struct tds_world* ptr, int cx, int y) {
+	/* The TDS_WORLD_CHUNK_SIZE tiles of row y inside chunk column cx, or NULL if the chunk is empty. */
+	const uint8_t* chunk = ptr->chunks[(y >> TDS_WORLD_CHUNK_SHIFT) * ptr->chunk_width + cx];
+	return chunk ? chunk + ((y & TDS_WORLD_CHUNK_MASK) << TDS_WORLD_CHUNK_SHIFT) : NULL;
+}
 
-			if (((flags_top & TDS_BLOCK_TYPE_NOLIGHT) || !(flags_top & TDS_BLOCK_TYPE_SOLID)) && !(flags & (TDS_BLOCK_TYPE_LTSLOPE | TDS_BLOCK_TYPE_RTSLOPE))) {
-				/* Out-facing up segment. */
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_right;
-				cur->y1 = block_top;
-				cur->x2 = block_left;
-				cur->y2 = block_top;
-				cur->nx = 0.0f;
-				cur->ny = 1.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+static void _tds_world_set(struct tds_world* ptr, int x, int y, uint8_t id) {
+	int index = (y >> TDS_WORLD_CHUNK_SHIFT) * ptr->chunk_width + (x >> TDS_WORLD_CHUNK_SHIFT);
+	uint8_t* chunk = ptr->chunks[index];
 
-			if ((flags_bottom & TDS_BLOCK_TYPE_NOLIGHT || !(flags_bottom & TDS_BLOCK_TYPE_SOLID)) && !(flags & (TDS_BLOCK_TYPE_LBSLOPE | TDS_BLOCK_TYPE_RBSLOPE))) {
-				/* Out-facing down segment. */
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_left;
-				cur->y1 = block_bottom;
-				cur->x2 = block_right;
-				cur->y2 = block_bottom;
-				cur->nx = 0.0f;
-				cur->ny = -1.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+	if (!chunk) {
+		if (!id) {
+			return;
+		}
 
-			if (flags & TDS_BLOCK_TYPE_LTSLOPE) {
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_left;
-				cur->y1 = block_bottom;
-				cur->x2 = block_right;
-				cur->y2 = block_top;
-				cur->nx = -1.0f;
-				cur->ny = 1.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+		chunk = ptr->chunks[index] = tds_malloc(TDS_WORLD_CHUNK_SIZE * TDS_WORLD_CHUNK_SIZE);
+		memset(chunk, 0, TDS_WORLD_CHUNK_SIZE * TDS_WORLD_CHUNK_SIZE);
+	}
 
-			if (flags & TDS_BLOCK_TYPE_RTSLOPE) {
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_right;
-				cur->y1 = block_bottom;
-				cur->x2 = block_left;
-				cur->y2 = block_top;
-				cur->nx = 1.0f;
-				cur->ny = 1.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+	uint8_t* tile = chunk + (((y & TDS_WORLD_CHUNK_MASK) << TDS_WORLD_CHUNK_SHIFT) | (x & TDS_WORLD_CHUNK_MASK));
 
-			if (flags & TDS_BLOCK_TYPE_RBSLOPE) {
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_left;
-				cur->y1 = block_bottom;
-				cur->x2 = block_right;
-				cur->y2 = block_top;
-				cur->nx = 1.0f;
-				cur->ny = -1.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+	uint64_t* bits = ptr->occupancy + y * ptr->occupancy_stride + (x >> 6);
 
-			if (flags & TDS_BLOCK_TYPE_LBSLOPE) {
-				cur = tds_malloc(sizeof *cur);
-				cur->x1 = block_left;
-				cur->y1 = block_top;
-				cur->x2 = block_right;
-				cur->y2 = block_bottom;
-				cur->nx = -1.0f;
-				cur->ny = -1.0f;
-				cur->next = ptr->segment_list;
-				if (ptr->segment_list) {
-					ptr->segment_list->prev = cur;
-				}
-				ptr->segment_list = cur;
-			}
+	if (!*tile && id) {
+		ptr->chunk_fill[index]++;
+		*bits |= 1ULL << (x & 63);
+	} else if (*tile && !id) {
+		ptr->chunk_fill[index]--;
+		*bits &= ~(1ULL << (x & 63));
+	}
+
+	*tile = id;
+
+	if (!ptr->chunk_fill[index]) {
+		tds_free(chunk);
+		ptr->chunks[index] = NULL;
+	}
+}
+
+static void _tds_world_free_chunks(struct tds_world* ptr) {
+	if (!ptr->chunks) {
+		return;
+	}
+
+	for (int i = 0; i < ptr->chunk_width * ptr->chunk_height; ++i) {
+		if (ptr->chunks[i]) {
+			tds_free(ptr->chunks[i]);
 		}
 	}
 
-	tds_logf(TDS_LOG_DEBUG, "Starting linear reduction phase.\n");
+	tds_free(ptr->chunks);
+	tds_free(ptr->chunk_fill);
+	tds_free(ptr->occupancy);
+
+	ptr->chunks = NULL;
+	ptr->chunk_fill = NULL;
+	ptr->occupancy = NULL;
+}
 
-	/* We will use a brute-force approach to keep the code small as this is not going to be called very often. */
-	int complete = 1, iterations = 0;
+static int _tds_world_match_flags(int flags, int flag_req, int flag_or, int flag_not) {
+	/* Returns the flags if they pass the overlap filter, 0 otherwise. A passing block always has at least one flag_or bit set. */
+	if ((flags & flag_req) != flag_req || !(flags & flag_or) || (flags & flag_not)) {
+		return 0;
+	}
 
-	while (complete) {
-		complete = 0;
+	return flags;
+}
 
-		struct tds_world_segment* reduction_cur = NULL, *reduction_target = ptr->segment_list, *tmp = NULL;
+static int _tds_world_tile_range(float lo, float hi, float half, int size, int* t0, int* t1) {
+	/* Conservative range of tiles touching [lo, hi] on one axis, padded by a tile on each side; the exact edge tests are done per tile.
+	 * The clamping happens in float so huge or NaN coordinates never reach the int conversion. */
+	float f0 = floorf(lo / TDS_WORLD_BLOCK_SIZE + half) - 1.0f;
+	float f1 = floorf(hi / TDS_WORLD_BLOCK_SIZE + half) + 1.0f;
 
-		/* In this pass, we consider all segments for reduction with other segments. If any actual reduction is done, we set the flag for another pass. */
-		tds_logf(TDS_LOG_DEBUG, "Starting linear reduction subphase iteration %d\n", iterations);
+	if (!(f0 < size) || !(f1 >= 0.0f)) {
+		return 0;
+	}
 
-		while (reduction_target) {
-			reduction_cur = ptr->segment_list;
+	*t0 = (f0 < 0.0f) ? 0 : (int) f0;
+	*t1 = (f1 >= size) ? size - 1 : (int) f1;
 
-			while (reduction_cur) {
-				/* Three nested while loops for linear reduction and n^2 traversal of a linked list. Crazy. */
+	return *t0 <= *t1;
+}
 
-				if (reduction_cur == reduction_target) {
-					reduction_cur = reduction_cur->next;
-					continue;
-				}
+static int _tds_world_overlap(struct tds_world* ptr, float left, float right, float bottom, float top, const int* matches, float* x, float* y, float* w, float* h, int flag_req, int flag_or, int flag_not) {
+	/* Only the tiles under the box are visited : rows bottom to top, tiles left to right, which is the order the hblock list is built in.
+	 * The first match is therefore the same block the old list walk returned, and it is reported as its whole hblock run.
+	 * Edges touching counts as an overlap. matches is an optional per-id table of _tds_world_match_flags results. */
 
-				if (reduction_cur->nx == 0.0f && reduction_target->nx == 0.0f && reduction_cur->ny == 1.0f && reduction_target->ny == 1.0f) {
-					/* Both of these lines are horizontal, and each segment's x2 is less than the x1. */
+	int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+	float half_w = ptr->width / 2.0f, half_h = ptr->height / 2.0f;
 
-					if (reduction_cur->y1 != reduction_target->y1) {
-						reduction_cur = reduction_cur->next;
-						continue;
-					}
+	if (!ptr->occupancy || !_tds_world_tile_range(left, right, half_w, ptr->width, &x0, &x1) || !_tds_world_tile_range(bottom, top, half_h, ptr->height, &y0, &y1)) {
+		return 0;
+	}
 
-					if (reduction_cur->x2 == reduction_target->x1) {
-						/* reduction_cur is on the right and we can reduce. */
-						reduction_target->x1 = reduction_cur->x1;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+	for (int ty = y0; ty <= y1; ++ty) {
+		float tile_top = (ty + 1.0f - half_h) * TDS_WORLD_BLOCK_SIZE;
+		float tile_bottom = (ty - half_h) * TDS_WORLD_BLOCK_SIZE;
 
-					if (reduction_target->x2 == reduction_cur->x1) {
-						/* reduction_target is on the right and we can reduce. */
-						reduction_target->x2 = reduction_cur->x2;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
-				}
+		if (top < tile_bottom || bottom > tile_top) {
+			continue;
+		}
 
-				if (reduction_cur->nx == 0.0f && reduction_target->nx == 0.0f && reduction_cur->ny == -1.0f && reduction_target->ny == -1.0f) {
-					/* Both of these lines are horizontal, and each segment's x2 is greater than the x1. */
+		const uint64_t* bits = ptr->occupancy + ty * ptr->occupancy_stride;
 
-					if (reduction_cur->y1 != reduction_target->y1) {
-						reduction_cur = reduction_cur->next;
-						continue;
-					}
+		for (int word = x0 >> 6; word <= x1 >> 6; ++word) {
+			uint64_t mask = bits[word];
 
-					if (reduction_cur->x1 == reduction_target->x2) {
-						/* reduction_cur is on the right and we can reduce. */
-						reduction_target->x2 = reduction_cur->x2;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+			if (word == x0 >> 6) {
+				mask &= ~0ULL << (x0 & 63);
+			}
 
-					if (reduction_target->x1 == reduction_cur->x2) {
-						/* reduction_target is on the right and we can reduce. */
-						reduction_target->x1 = reduction_cur->x1;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+			if (word == x1 >> 6) {
+				mask &= ~0ULL >> (63 - (x1 & 63));
+			}
+
+			while (mask) {
+				int tx = (word << 6) | __builtin_ctzll(mask);
+				mask &= mask - 1;
+
+				if (left > (tx + 1 - half_w) * TDS_WORLD_BLOCK_SIZE || right < (tx - half_w) * TDS_WORLD_BLOCK_SIZE) {
+					continue;
 				}
 
-				if (reduction_cur->nx == 1.0f && reduction_target->nx == 1.0f && reduction_cur->ny == 0.0f && reduction_target->ny == 0.0f) {
-					/* Both of these lines are vertical, and each segment's y2 is greater than the y1. */
+				uint8_t id = _tds_world_get(ptr, tx, ty);
+				int flags = matches ? matches[id] : _tds_world_match_flags(tds_block_map_get(tds_engine_global->block_map_handle, id).flags, flag_req, flag_or, flag_not);
 
-					if (reduction_cur->x1 != reduction_target->x1) {
-						reduction_cur = reduction_cur->next;
-						continue;
-					}
+				if (!flags) {
+					continue;
+				}
 
-					if (reduction_cur->y2 == reduction_target->y1) {
-						/* reduction_cur is on the bottom and we can reduce. */
-						reduction_target->y1 = reduction_cur->y1;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+				/* Widen the hit to the run of identical blocks it belongs to, which is its hblock unless rectangles are merged. */
+				int run_left = tx, run_right = tx;
 
-					if (reduction_target->y2 == reduction_cur->y1) {
-						/* reduction_target is on the bottom and we can reduce. */
-						reduction_target->y2 = reduction_cur->y2;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tds_free(reduction_cur);
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+				while (run_left > 0 && _tds_world_get(ptr, run_left - 1, ty) == id) {
+					--run_left;
 				}
 
-				if (reduction_cur->nx == -1.0f && reduction_target->nx == -1.0f && reduction_cur->ny == 0.0f && reduction_target->ny == 0.0f) {
-					/* Both of these lines are vertical, and each segment's y2 is less than the y1. */
+				while (run_right < ptr->width - 1 && _tds_world_get(ptr, run_right + 1, ty) == id) {
+					++run_right;
+				}
 
-					if (reduction_cur->x1 != reduction_target->x1) {
-						reduction_cur = reduction_cur->next;
-						continue;
-					}
+				float hit_left = (run_left - half_w) * TDS_WORLD_BLOCK_SIZE;
+				float hit_right = (run_right + 1 - half_w) * TDS_WORLD_BLOCK_SIZE;
 
-					if (reduction_cur->y2 == reduction_target->y1) {
-						/* reduction_cur is on the top and we can reduce. */
-						reduction_target->y1 = reduction_cur->y1;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+				if (x) {
+					*x = (hit_left + hit_right) / 2.0f;
+				}
 
-					if (reduction_target->y2 == reduction_cur->y1) {
-						/* reduction_target is on the top and we can reduce. */
-						reduction_target->y2 = reduction_cur->y2;
-
-						if (reduction_cur->prev) {
-							reduction_cur->prev->next = reduction_cur->next;
-						} else {
-							ptr->segment_list = reduction_cur->next;
-						}
-
-						if (reduction_cur->next) {
-							reduction_cur->next->prev = reduction_cur->prev;
-						}
-
-						tmp = reduction_cur->next;
-						tds_free(reduction_cur);
-						reduction_cur = tmp;
-						complete = 1;
-						continue;
-					}
+				if (y) {
+					*y = (tile_top + tile_bottom) / 2.0f;
+				}
+
+				if (w) {
+					*w = hit_right - hit_left;
 				}
 
-				reduction_cur = reduction_cur->next;
+				if (h) {
+					*h = tile_top - tile_bottom;
+				}
+
+				return flags;
 			}
+		}
+	}
+
+	return 0;
+}
+
 
-			reduction_target = reduction_target->next;
+static int _tds_world_sweep_axis(float box_min, float box_max, float shape_min, float shape_max, float v, float* entry, float* exit) {
+	/* One separating axis : the interval of time the moving box overlaps the shape along it. Returns 0 if they never overlap on this axis.
+	 * Touching intervals do not overlap, so a box resting on or sliding along a face is not stopped by it; without motion on the axis,
+	 * overlaps within the slack count as touching too, otherwise rounding would catch a sliding box on the side of a level neighbour. */
+	if (v > 0.0f) {
+		*entry = (shape_min - box_max) / v;
+		*exit = (shape_max - box_min) / v;
+	} else if (v < 0.0f) {
+		*entry = (shape_max - box_min) / v;
+		*exit = (shape_min - box_max) / v;
+	} else {
+		if (box_max <= shape_min + TDS_WORLD_SWEEP_SLACK || box_min >= shape_max - TDS_WORLD_SWEEP_SLACK) {
+			return 0;
 		}
 
-		++iterations;
+		*entry = -INFINITY;
+		*exit = INFINITY;
 	}
 
-	tds_logf(TDS_LOG_DEBUG, "Finished linear reduction phase in %d passes.\n", iterations);
+	return 1;
+}
 
-	cur = ptr->segment_list;
+static int _tds_world_sweep_tile(struct tds_world* ptr, float left, float right, float bottom, float top, float dx, float dy, int tx, int ty, int flags, struct tds_world_sweep_result* result) {
+	/* Swept box against one block, using the separating axes of the block shape : x, y and the slanted face of a slope.
+	 * The contact time is the latest axis entry, provided it comes before the earliest axis exit. Updates result if this contact is earlier. */
+
+	float tile_left = (tx - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+	float tile_right = (tx + 1.0f - ptr->width / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+	float tile_bottom = (ty - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+	float tile_top = (ty + 1.0f - ptr->height / 2.0f) * TDS_WORLD_BLOCK_SIZE;
+
+	float entry = -INFINITY, exit = INFINITY, axis_entry = 0.0f, axis_exit = 0.0f, nx = 0.0f, ny = 0.0f, entry_speed = 0.0f;
+	int slope = 0;
+
+	/* The outward normal of the slanted face, unnormalized : the solid half of the tile is on the opposite side of the diagonal. */
+	float sx = 0.0f, sy = 0.0f;
+
+	if (flags & TDS_BLOCK_TYPE_LTSLOPE) {
+		slope = TDS_BLOCK_TYPE_LTSLOPE;
+		sx = -1.0f;
+		sy = 1.0f;
+	} else if (flags & TDS_BLOCK_TYPE_RTSLOPE) {
+		slope = TDS_BLOCK_TYPE_RTSLOPE;
+		sx = 1.0f;
+		sy = 1.0f;
+	} else if (flags & TDS_BLOCK_TYPE_RBSLOPE) {
+		slope = TDS_BLOCK_TYPE_RBSLOPE;
+		sx = 1.0f;
+		sy = -1.0f;
+	} else if (flags & TDS_BLOCK_TYPE_LBSLOPE) {
+		slope = TDS_BLOCK_TYPE_LBSLOPE;
+		sx = -1.0f;
+		sy = -1.0f;
+	}
 
-	/* We iterate through the segment list twice. Once to grab the size of the list, and another to copy the segment data to the temporary buffer. */
+	if (slope) {
+		/* The slanted face goes through the two tile corners that project highest on its normal, the right-angle corner projects lowest. */
+		float box_center = (left + right) / 2.0f * sx + (bottom + top) / 2.0f * sy;
+		float box_extent = (right - left) / 2.0f + (top - bottom) / 2.0f;
+		float face = ((sx > 0.0f) ? tile_left : tile_right) * sx + ((sy > 0.0f) ? tile_bottom : tile_top) * sy + TDS_WORLD_BLOCK_SIZE;
+		float v = dx * sx + dy * sy;
 
-	int segment_count = 0;
+		if (!_tds_world_sweep_axis(box_center - box_extent, box_center + box_extent, face - TDS_WORLD_BLOCK_SIZE, face, v, &axis_entry, &axis_exit)) {
+			return 0;
+		}
 
-	while (cur) {
-		segment_count++;
-		cur = cur->next;
+		entry = axis_entry;
+		exit = axis_exit;
+		nx = sx * (float) M_SQRT1_2;
+		ny = sy * (float) M_SQRT1_2;
+		entry_speed = fabsf(v) * (float) M_SQRT1_2;
 	}
 
-	struct tds_vertex* segment_verts = tds_malloc(segment_count * sizeof(struct tds_vertex) * 2);
-	cur = ptr->segment_list;
+	/* The slanted face is tested first so a contact exactly on the corner where it meets flat ground reports the slope. */
+	if (!_tds_world_sweep_axis(left, right, tile_left, tile_right, dx, &axis_entry, &axis_exit)) {
+		return 0;
+	}
 
-	int i = 0;
+	if (axis_entry > entry) {
+		entry = axis_entry;
+		nx = (dx > 0.0f) ? -1.0f : 1.0f;
+		ny = 0.0f;
+		entry_speed = fabsf(dx);
+		slope = 0;
+	}
 
-	while (cur) {
-		struct tds_vertex verts[] = {
-			{cur->x1, cur->y1, 0.0f, cur->nx, cur->ny}, /* We hide the normal in the texcoords, saving some time. */
-			{cur->x2, cur->y2, 0.0f, cur->nx, cur->ny},
-		};
+	exit = fminf(exit, axis_exit);
 
-		if (i >= segment_count) {
-			break;
-		}
+	if (!_tds_world_sweep_axis(bottom, top, tile_bottom, tile_top, dy, &axis_entry, &axis_exit)) {
+		return 0;
+	}
 
-		segment_verts[2 * i] = verts[0];
-		segment_verts[2 * i + 1] = verts[1];
+	if (axis_entry > entry) {
+		entry = axis_entry;
+		nx = 0.0f;
+		ny = (dy > 0.0f) ? -1.0f : 1.0f;
+		entry_speed = fabsf(dy);
+		slope = 0;
+	}
 
-		cur = cur->next;
+	exit = fminf(exit, axis_exit);
 
-		++i;
+	/* Starting inside the block (beyond rounding slack) means the box is embedded, and it is left free to move out. */
+	if (entry >= exit || entry > result->t || !(entry * entry_speed >= -TDS_WORLD_SWEEP_SLACK)) {
+		return 0;
 	}
 
-	ptr->segment_vb = tds_vertex_buffer_create(segment_verts, segment_count * 2, GL_LINES);
-	tds_free(segment_verts);
+	entry = fmaxf(entry, 0.0f);
+
+	if (result->flags && entry >= result->t) {
+		return 0;
+	}
+
+	result->t = entry;
+	result->nx = nx;
+	result->ny = ny;
+	result->flags = flags;
+	result->slope = slope;
+	result->tile_x = tx;
+	result->tile_y = ty;
+
+	return 1;
 }
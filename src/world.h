@@ -6,22 +6,58 @@
 #include "quadtree.h"
 
 #define TDS_WORLD_BLOCK_SIZE 0.5f
+#define TDS_WORLD_SWEEP_SLACK 0.001f /* How far a box may start inside a block (rounding from earlier moves) and still collide with it in tds_world_sweep. */
+
+/* Tiles are stored in square chunks of TDS_WORLD_CHUNK_SIZE block ids, row-major within each chunk and in the chunk table.
+ * Chunks holding nothing but air are never allocated. */
+#define TDS_WORLD_CHUNK_SHIFT 5
+#define TDS_WORLD_CHUNK_SIZE (1 << TDS_WORLD_CHUNK_SHIFT)
+#define TDS_WORLD_CHUNK_MASK (TDS_WORLD_CHUNK_SIZE - 1)
 
 struct tds_world_hblock {
-	int x, y, w, id;
+	int x, y, w, h, id; /* h is always 1 unless rectangles are merged, (x, y) is the bottom left tile. */
 	struct tds_world_hblock* next;
 	struct tds_vertex_buffer* vb;
 };
 
 struct tds_world_segment {
 	float x1, y1, x2, y2, nx, ny; /* Segment locations are not in world space, they are in game space. No conversion necessary. */
-	struct tds_world_segment* next, *prev;
+};
+
+struct tds_world_block_edit {
+	int x, y;
+	uint8_t id;
+};
+
+struct tds_world_overlap_query {
+	float x, y, w, h; /* Box center and size, in game space. */
+	int flags; /* Set by tds_world_get_overlap_batch : flags of the first matching block, 0 if there was no match. */
+	float hit_x, hit_y, hit_w, hit_h; /* Set on a match : center and size of the matched run of blocks (the hblock, unless rectangles are merged). */
+};
+
+struct tds_world_sweep_result {
+	float t; /* Fraction of the motion completed at the first contact, 1.0f if nothing was hit. */
+	float nx, ny; /* Unit contact normal pointing out of the block, zero if nothing was hit. */
+	int flags; /* Flags of the block that was hit, 0 if nothing was hit. */
+	int slope; /* The TDS_BLOCK_TYPE_*SLOPE bit if the contact was on the slanted face of a slope, 0 for flat faces. */
+	int tile_x, tile_y;
 };
 
 struct tds_world {
-	int** buffer, width, height;
+	int width, height;
+	uint8_t** chunks; /* chunk_width * chunk_height entries, NULL for empty chunks. */
+	uint16_t* chunk_fill; /* Non-air tiles in each chunk, a chunk is released when this drops back to 0. */
+	int chunk_width, chunk_height;
+	uint64_t* occupancy; /* One bit per non-air tile, occupancy_stride words per row. Overlap queries skip empty space 64 tiles at a time. */
+	int occupancy_stride;
 	struct tds_world_hblock* block_list_head, *block_list_tail;
-	struct tds_world_segment* segment_list;
+	struct tds_world_hblock** hblock_rows; /* First hblock of each row in block_list, NULL for empty rows. Lets a single row be spliced out and rebuilt. */
+	int merge_rects; /* Merge same-id tiles into rectangles instead of horizontal runs. The block list is then unordered and hblock_rows is unused. */
+	/* Light occluder segments, grouped in buckets : horizontal edge lines 0..height, then vertical edge lines 0..width, then the slopes of each row.
+	 * Bucket b spans segments[segment_buckets[b]] up to segments[segment_buckets[b + 1]]. */
+	struct tds_world_segment* segments;
+	int segment_count, segment_capacity;
+	int* segment_buckets;
 	struct tds_vertex_buffer* segment_vb;
 	struct tds_quadtree* quadtree;
 };
@@ -34,7 +70,28 @@ void tds_world_load(struct tds_world* ptr, const uint8_t* block_buffer, int widt
 void tds_world_save(struct tds_world* ptr, uint8_t* block_buffer, int width, int height);
 
 void tds_world_set_block(struct tds_world* ptr, int x, int y, uint8_t block);
-uint8_t tds_world_get_block(struct tds_world* ptr, int x, int y);
+void tds_world_set_blocks(struct tds_world* ptr, const struct tds_world_block_edit* edits, int count); /* Applies every edit, then regenerates once. */
+uint8_t tds_world_get_block(struct tds_world* ptr, int x, int y); /* Out of bounds reads as air. */
+
+/* Rebuild the hblock list (with its quadtree and vertex buffers) and the lighting segments from the block buffer.
+ * load calls these already, they are public for tools and the benchmark target.
+ * Block edits do not need a full rebuild : only the edited rows, the edge lines around them and the segment vertex buffer are regenerated. */
+void tds_world_generate_hblocks(struct tds_world* ptr);
+void tds_world_generate_segments(struct tds_world* ptr);
+
+/* Greedy rectangle merging cuts the hblock count (and with it vertex buffers, quadtree entries and draw calls) on blocky maps.
+ * Merged hblocks repeat their texture vertically as well as horizontally; tds_block_map_add sets block textures to wrap on both axes.
+ * Edits only re-merge the rows around the edited tiles. Switching modes on a loaded world regenerates its hblocks. */
+void tds_world_set_merge_rects(struct tds_world* ptr, int enable);
 
 int tds_world_get_overlap_fast(struct tds_world* ptr, struct tds_object* obj, float* x, float* y, float* w, float* h, int flag_req, int flag_or, int flag_not); /* The "fast" overlap is a super-quick method of intersection, but it requires that the object is axis-aligned. */
 /* tds_world_get_overlap_fast will store the x and y coordinates of the collided hblock in x and y if there is a collision, likewise for cblock width and height in world space */
+
+/* Overlap queries only visit the tiles under the box, the first match is the lowest row, leftmost block, same as the hblock order. */
+int tds_world_get_overlap_box(struct tds_world* ptr, float x, float y, float w, float h, float* hit_x, float* hit_y, float* hit_w, float* hit_h, int flag_req, int flag_or, int flag_not);
+int tds_world_get_overlap_batch(struct tds_world* ptr, struct tds_world_overlap_query* queries, int count, int flag_req, int flag_or, int flag_not); /* Returns the number of queries that matched. */
+
+/* tds_world_sweep moves the box (center x, y, size w, h) by (dx, dy) and finds the first block it runs into, in a single pass over the tiles the motion covers.
+ * Slope blocks collide as their solid triangle, everything else as a full tile. Faces the box only touches or moves away from never stop it,
+ * and blocks the box already starts inside are ignored so it can always move back out. Returns nonzero on a hit; result may be NULL. */
+int tds_world_sweep(struct tds_world* ptr, float x, float y, float w, float h, float dx, float dy, int flag_req, int flag_or, int flag_not, struct tds_world_sweep_result* result);